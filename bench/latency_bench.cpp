@@ -0,0 +1,198 @@
+#include "spindle/thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include "spindle/latch.h"
+#include "spindle/semaphore.h"
+
+#include "worker.h"
+
+#include "benchmark/benchmark.h"
+
+// These benchmarks measure the latency of individual tasks rather than the throughput of batches.
+// Each one reports the 50th, 99th and 99.9th percentiles and the maximum of its samples as
+// counters, in microseconds. Run with `--benchmark_format=json`, or with `--benchmark_out`, to
+// compare them across builds.
+
+namespace {
+
+using spindle::clock;
+
+void report_percentiles(benchmark::State& state, std::vector<clock::duration>& samples) {
+    if (samples.empty()) return;
+    std::sort(samples.begin(), samples.end());
+    auto at = [&](double q) {
+        size_t idx = std::min(samples.size() - 1, static_cast<size_t>(q * samples.size()));
+        return std::chrono::duration<double, std::micro>(samples[idx]).count();
+    };
+    state.counters["p50_us"] = at(0.5);
+    state.counters["p99_us"] = at(0.99);
+    state.counters["p999_us"] = at(0.999);
+    state.counters["max_us"] = at(1);
+}
+
+// Submits a task to `pool` and waits for it to finish. Returns how long the task waited to start.
+clock::duration probe(spindle::ThreadPool& pool) {
+    spindle::Latch latch{};
+    clock::duration latency{};
+    clock::time_point queued = clock::now();
+    pool.execute([&] {
+        latency = clock::now() - queued;
+        latch.decrement();
+    });
+    latch.wait();
+    return latency;
+}
+
+} // namespace
+
+// Measures how long a task waits between `execute` and the start of its execution, while chains of
+// short tasks keep the pool idle (0), about half busy (1) or saturated with a backlog (2). The time
+// of an iteration is the latency of its task.
+static void BM_EnqueueToStart(benchmark::State& state) {
+    uint32_t num_threads = state.range(0);
+    int64_t load = state.range(1);
+    spindle::ThreadPool pool{num_threads};
+
+    std::atomic_bool done{};
+    std::function<void()> chain = [&] {
+        for (int i = 0; i < 1024; ++i) {
+            benchmark::DoNotOptimize(i);
+        }
+        if (!done) pool.execute(chain);
+    };
+    uint32_t num_chains = 0;
+    if (load == 1) num_chains = std::max(num_threads / 2, 1u);
+    if (load == 2) num_chains = 4 * num_threads;
+    for (uint32_t i = 0; i < num_chains; ++i) {
+        pool.execute(chain);
+    }
+
+    std::vector<clock::duration> samples;
+    for (auto _ : state) {
+        clock::duration latency = probe(pool);
+        state.SetIterationTime(std::chrono::duration<double>(latency).count());
+        samples.push_back(latency);
+    }
+    done = true;
+    pool.drain();
+    report_percentiles(state, samples);
+}
+
+BENCHMARK(BM_EnqueueToStart)
+    ->ArgNames({"threads", "load"})
+    ->ArgsProduct({
+        {2, 4},   // pool size
+        {0, 1, 2} // idle, moderate, saturated
+    })
+    ->UseManualTime()
+    ->Unit(benchmark::kMicrosecond);
+
+// Measures how long a task submitted to a pool that has been idle for a while waits to start, which
+// shows whether threads that spun down to blocking wake up promptly.
+static void BM_WakeupAfterIdle(benchmark::State& state) {
+    spindle::ThreadPoolOptions options;
+    options.num_threads = 1;
+    options.wait_strategy = static_cast<spindle::WaitStrategy>(state.range(1));
+    spindle::ThreadPool pool{options};
+    std::chrono::microseconds idle{state.range(0)};
+
+    std::vector<clock::duration> samples;
+    for (auto _ : state) {
+        std::this_thread::sleep_for(idle);
+        clock::duration latency = probe(pool);
+        state.SetIterationTime(std::chrono::duration<double>(latency).count());
+        samples.push_back(latency);
+    }
+    report_percentiles(state, samples);
+}
+
+BENCHMARK(BM_WakeupAfterIdle)
+    ->ArgNames({"idle_us", "strategy"})
+    ->ArgsProduct({
+        {10, 1000, 10000}, // idle period
+        {0, 1, 2}          // park, adaptive, spin
+    })
+    ->Iterations(200)
+    ->UseManualTime()
+    ->Unit(benchmark::kMicrosecond);
+
+// Runs a `Worker` with the default timer resolution on a thread of its own.
+class TimerFixture : public benchmark::Fixture {
+  public:
+    void SetUp(const benchmark::State& state) override {
+        worker = std::make_unique<spindle::Worker>();
+        thread = std::thread{[this] { worker->run(); }};
+    }
+
+    void TearDown(const benchmark::State& state) override {
+        if (!thread.joinable()) return;
+        worker->terminate();
+        thread.join();
+    }
+
+  protected:
+    std::unique_ptr<spindle::Worker> worker;
+    std::thread thread;
+};
+
+// Measures how late a deferred task fires past its deadline.
+BENCHMARK_DEFINE_F(TimerFixture, DeferredTaskError)(benchmark::State& state) {
+    std::chrono::microseconds delay{state.range(0)};
+    std::vector<clock::duration> samples;
+    for (auto _ : state) {
+        spindle::Latch latch{};
+        clock::duration error{};
+        clock::time_point deadline = clock::now() + delay;
+        worker->schedule(
+            [&] {
+                error = clock::now() - deadline;
+                latch.decrement();
+            },
+            delay);
+        latch.wait();
+        samples.push_back(error);
+    }
+    report_percentiles(state, samples);
+}
+
+BENCHMARK_REGISTER_F(TimerFixture, DeferredTaskError)
+    ->ArgName("delay_us")
+    ->Arg(100)
+    ->Arg(1000)
+    ->Arg(10000)
+    ->Unit(benchmark::kMillisecond);
+
+// Measures how late each run of a periodic task fires past its ideal schedule, which also exposes
+// any drift of the period.
+BENCHMARK_DEFINE_F(TimerFixture, PeriodicTaskError)(benchmark::State& state) {
+    std::chrono::microseconds period{state.range(0)};
+    std::vector<clock::duration> samples;
+    spindle::Semaphore fired;
+    clock::time_point deadline = clock::now() + period;
+    worker->schedule(
+        [&] {
+            samples.push_back(clock::now() - deadline);
+            deadline += period;
+            fired.release();
+        },
+        period, true);
+    for (auto _ : state) {
+        fired.acquire();
+    }
+    // The samples are only read once the `Worker` has stopped.
+    worker->terminate();
+    thread.join();
+    report_percentiles(state, samples);
+}
+
+BENCHMARK_REGISTER_F(TimerFixture, PeriodicTaskError)
+    ->ArgName("period_us")
+    ->Arg(1000)
+    ->Arg(10000)
+    ->Unit(benchmark::kMillisecond);
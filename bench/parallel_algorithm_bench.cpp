@@ -0,0 +1,168 @@
+#include "spindle/parallel_algorithm.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "spindle/thread_pool.h"
+
+#include "benchmark/benchmark.h"
+
+// Each parallel algorithm against its standard counterpart, on random 32-bit integers, from 1K to
+// 10M elements, which keeps the buffers of a run to about a hundred MB on CI runners. The pool has
+// a thread per hardware thread.
+class ParallelAlgorithmFixture : public benchmark::Fixture {
+  public:
+    void SetUp(const benchmark::State& state) override {
+        thread_pool = std::make_unique<spindle::ThreadPool>(
+            std::max(std::thread::hardware_concurrency(), 1u));
+        std::minstd_rand rng{42};
+        data.resize(state.range(0));
+        for (uint32_t& x : data) {
+            x = rng();
+        }
+        out.resize(data.size());
+    }
+
+    void TearDown(const benchmark::State& state) override {
+        thread_pool->tear_down();
+        // Fixtures live as long as the program, so their buffers must be released explicitly.
+        std::vector<uint32_t>{}.swap(data);
+        std::vector<uint32_t>{}.swap(out);
+    }
+
+  protected:
+    // A function object rather than a function, so that it is inlined into both algorithms.
+    struct Mix {
+        uint32_t operator()(uint32_t x) const {
+            x ^= x >> 16;
+            x *= 0x45d9f3b;
+            return x ^ (x >> 16);
+        }
+    };
+
+    // Every iteration sorts a fresh copy of the unsorted data, which is not timed.
+    template <class Sort>
+    void sort(benchmark::State& state, Sort sort) {
+        for (auto _ : state) {
+            state.PauseTiming();
+            std::copy(data.begin(), data.end(), out.begin());
+            state.ResumeTiming();
+            sort(out.begin(), out.end());
+            benchmark::ClobberMemory();
+        }
+        state.SetItemsProcessed(state.iterations() * data.size());
+    }
+
+    // The element searched for is three quarters into the data.
+    bool is_target(uint32_t x) const {
+        return x == data[data.size() * 3 / 4];
+    }
+
+    std::unique_ptr<spindle::ThreadPool> thread_pool;
+    std::vector<uint32_t> data;
+    std::vector<uint32_t> out;
+};
+
+BENCHMARK_DEFINE_F(ParallelAlgorithmFixture, StdSort)(benchmark::State& state) {
+    sort(state, [](auto first, auto last) { std::sort(first, last); });
+}
+
+BENCHMARK_DEFINE_F(ParallelAlgorithmFixture, ParallelSort)(benchmark::State& state) {
+    sort(state, [this](auto first, auto last) {
+        spindle::parallel_sort(*thread_pool, first, last);
+    });
+}
+
+BENCHMARK_DEFINE_F(ParallelAlgorithmFixture, StdPartialSum)(benchmark::State& state) {
+    for (auto _ : state) {
+        std::partial_sum(data.begin(), data.end(), out.begin());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * data.size());
+}
+
+BENCHMARK_DEFINE_F(ParallelAlgorithmFixture, ParallelInclusiveScan)(benchmark::State& state) {
+    for (auto _ : state) {
+        spindle::parallel_inclusive_scan(*thread_pool, data.begin(), data.end(), out.begin());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * data.size());
+}
+
+BENCHMARK_DEFINE_F(ParallelAlgorithmFixture, StdTransform)(benchmark::State& state) {
+    for (auto _ : state) {
+        std::transform(data.begin(), data.end(), out.begin(), Mix{});
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * data.size());
+}
+
+BENCHMARK_DEFINE_F(ParallelAlgorithmFixture, ParallelTransform)(benchmark::State& state) {
+    for (auto _ : state) {
+        spindle::parallel_transform(*thread_pool, data.begin(), data.end(), out.begin(), Mix{});
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * data.size());
+}
+
+BENCHMARK_DEFINE_F(ParallelAlgorithmFixture, StdFindIf)(benchmark::State& state) {
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(
+            std::find_if(data.begin(), data.end(), [this](uint32_t x) { return is_target(x); }));
+    }
+    state.SetItemsProcessed(state.iterations() * data.size());
+}
+
+BENCHMARK_DEFINE_F(ParallelAlgorithmFixture, ParallelFindIf)(benchmark::State& state) {
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(spindle::parallel_find_if(
+            *thread_pool, data.begin(), data.end(), [this](uint32_t x) { return is_target(x); }));
+    }
+    state.SetItemsProcessed(state.iterations() * data.size());
+}
+
+BENCHMARK_REGISTER_F(ParallelAlgorithmFixture, StdSort)
+    ->RangeMultiplier(10)
+    ->Range(1000, 10'000'000)
+    ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_REGISTER_F(ParallelAlgorithmFixture, ParallelSort)
+    ->RangeMultiplier(10)
+    ->Range(1000, 10'000'000)
+    ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_REGISTER_F(ParallelAlgorithmFixture, StdPartialSum)
+    ->RangeMultiplier(10)
+    ->Range(1000, 10'000'000)
+    ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_REGISTER_F(ParallelAlgorithmFixture, ParallelInclusiveScan)
+    ->RangeMultiplier(10)
+    ->Range(1000, 10'000'000)
+    ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_REGISTER_F(ParallelAlgorithmFixture, StdTransform)
+    ->RangeMultiplier(10)
+    ->Range(1000, 10'000'000)
+    ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_REGISTER_F(ParallelAlgorithmFixture, ParallelTransform)
+    ->RangeMultiplier(10)
+    ->Range(1000, 10'000'000)
+    ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_REGISTER_F(ParallelAlgorithmFixture, StdFindIf)
+    ->RangeMultiplier(10)
+    ->Range(1000, 10'000'000)
+    ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_REGISTER_F(ParallelAlgorithmFixture, ParallelFindIf)
+    ->RangeMultiplier(10)
+    ->Range(1000, 10'000'000)
+    ->Unit(benchmark::kMicrosecond);
@@ -1,6 +1,7 @@
 #include "spindle/thread_pool.h"
 
 #include "spindle/latch.h"
+#include "spindle/parallel_for.h"
 
 #include "benchmark/benchmark.h"
 
@@ -69,3 +70,18 @@ BENCHMARK_REGISTER_F(PrimeSieve, FindInRange)
     ->Iterations(10)
     ->RangeMultiplier(2)
     ->Range(1, 8);
+
+BENCHMARK_DEFINE_F(PrimeSieve, ParallelFor)(benchmark::State& state) {
+    for (auto _ : state) {
+        std::vector<short> primes(search_range_max);
+        spindle::parallel_for(*thread_pool, search_range_min, search_range_max, [&](int num) {
+            primes[num] = is_prime(num) ? 1 : 0;
+        });
+    }
+}
+
+BENCHMARK_REGISTER_F(PrimeSieve, ParallelFor)
+    ->Unit(benchmark::kMillisecond)
+    ->Iterations(10)
+    ->RangeMultiplier(2)
+    ->Range(1, 8);
@@ -0,0 +1,92 @@
+#include "spindle/strand.h"
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "spindle/latch.h"
+#include "spindle/thread_pool.h"
+
+#include "benchmark/benchmark.h"
+
+// Many actors, each of which must process its messages one at a time, share a pool. Each message
+// does a little work on the state of its actor.
+class ActorFixture : public benchmark::Fixture {
+  public:
+    void SetUp(const benchmark::State& state) override {
+        thread_pool = std::make_unique<spindle::ThreadPool>(4);
+    }
+
+    void TearDown(const benchmark::State& state) override {
+        thread_pool->tear_down();
+    }
+
+  protected:
+    static constexpr int num_messages = 100000;
+
+    static void work(uint64_t& state) {
+        for (int i = 0; i < 64; ++i) {
+            benchmark::DoNotOptimize(state = state * 31 + i);
+        }
+    }
+
+    std::unique_ptr<spindle::ThreadPool> thread_pool;
+};
+
+// Each actor is a `Strand`.
+BENCHMARK_DEFINE_F(ActorFixture, Strand)(benchmark::State& state) {
+    int num_actors = state.range(0);
+    std::vector<spindle::Strand> strands;
+    for (int i = 0; i < num_actors; ++i) {
+        strands.emplace_back(*thread_pool);
+    }
+    std::vector<uint64_t> actors(num_actors);
+    for (auto _ : state) {
+        spindle::Latch done{num_messages};
+        for (int i = 0; i < num_messages; ++i) {
+            int a = i % num_actors;
+            strands[a].execute([&, a] {
+                work(actors[a]);
+                done.decrement();
+            });
+        }
+        done.wait();
+    }
+    state.SetItemsProcessed(state.iterations() * num_messages);
+}
+
+// Each actor guards its state with a mutex, and its messages are plain tasks of the pool.
+BENCHMARK_DEFINE_F(ActorFixture, Mutex)(benchmark::State& state) {
+    int num_actors = state.range(0);
+    std::vector<std::mutex> mutexes(num_actors);
+    std::vector<uint64_t> actors(num_actors);
+    for (auto _ : state) {
+        spindle::Latch done{num_messages};
+        for (int i = 0; i < num_messages; ++i) {
+            int a = i % num_actors;
+            thread_pool->execute([&, a] {
+                {
+                    std::lock_guard<std::mutex> lk{mutexes[a]};
+                    work(actors[a]);
+                }
+                done.decrement();
+            });
+        }
+        done.wait();
+    }
+    state.SetItemsProcessed(state.iterations() * num_messages);
+}
+
+BENCHMARK_REGISTER_F(ActorFixture, Strand)
+    ->ArgName("actors")
+    ->RangeMultiplier(10)
+    ->Range(1, 1000)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK_REGISTER_F(ActorFixture, Mutex)
+    ->ArgName("actors")
+    ->RangeMultiplier(10)
+    ->Range(1, 1000)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
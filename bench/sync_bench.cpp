@@ -0,0 +1,51 @@
+#include <mutex>
+
+#include "spindle/barrier.h"
+#include "spindle/latch.h"
+#include "spindle/semaphore.h"
+
+#include "benchmark/benchmark.h"
+
+// Concurrent decrements of a shared `Latch` that never reaches zero, which is the pattern of many
+// tasks signalling completion of a batch. A mutex-guarded counter is the baseline.
+static void BM_LatchDecrement(benchmark::State& state) {
+    static spindle::Latch* latch;
+    if (state.thread_index() == 0) latch = new spindle::Latch(spindle::Latch::max_weight);
+    for (auto _ : state) {
+        latch->decrement();
+    }
+    if (state.thread_index() == 0) delete latch;
+}
+
+static void BM_MutexDecrement(benchmark::State& state) {
+    static std::mutex m;
+    static uint32_t weight;
+    if (state.thread_index() == 0) weight = spindle::Latch::max_weight;
+    for (auto _ : state) {
+        std::lock_guard<std::mutex> lk{m};
+        benchmark::DoNotOptimize(--weight);
+    }
+}
+
+static void BM_SemaphoreAcquireRelease(benchmark::State& state) {
+    static spindle::Semaphore semaphore{1};
+    for (auto _ : state) {
+        semaphore.acquire();
+        semaphore.release();
+    }
+}
+
+static void BM_BarrierArriveAndWait(benchmark::State& state) {
+    static spindle::Barrier* barrier;
+    if (state.thread_index() == 0) barrier = new spindle::Barrier(state.threads());
+    // Every thread must arrive the same number of times, so the iteration count is fixed.
+    for (auto _ : state) {
+        barrier->arrive_and_wait();
+    }
+    if (state.thread_index() == 0) delete barrier;
+}
+
+BENCHMARK(BM_LatchDecrement)->ThreadRange(1, 8);
+BENCHMARK(BM_MutexDecrement)->ThreadRange(1, 8);
+BENCHMARK(BM_SemaphoreAcquireRelease)->ThreadRange(1, 8);
+BENCHMARK(BM_BarrierArriveAndWait)->ThreadRange(1, 8)->Iterations(10'000);
@@ -0,0 +1,92 @@
+#include "spindle/task.h"
+
+#include <functional>
+
+#include "counting_allocator.h"
+#include "spindle/latch.h"
+#include "spindle/thread_pool.h"
+
+#include "benchmark/benchmark.h"
+
+namespace {
+
+// A closure of a typical size: a few captured values and a pointer to shared state.
+struct Payload {
+    uint64_t a, b, c, d;
+};
+
+void report_allocations(benchmark::State& state, uint64_t start, uint64_t tasks_per_iter) {
+    double num_tasks = static_cast<double>(state.iterations()) * tasks_per_iter;
+    state.counters["allocs_per_task"] = (spindle::test::global_allocations() - start) / num_tasks;
+}
+
+} // namespace
+
+// Mirrors the former hot path, where a `std::function` was copied from `ThreadPool::execute` into
+// the worker queue and out of it again before running.
+static void BM_StdFunctionCopies(benchmark::State& state) {
+    Payload payload{1, 2, 3, 4};
+    uint64_t sum = 0;
+    uint64_t start = spindle::test::global_allocations();
+    for (auto _ : state) {
+        std::function<void()> func{[payload, &sum] { sum += payload.a + payload.d; }};
+        std::function<void()> queued{func};
+        std::function<void()> popped{queued};
+        popped();
+    }
+    benchmark::DoNotOptimize(sum);
+    report_allocations(state, start, 1);
+}
+BENCHMARK(BM_StdFunctionCopies);
+
+static void BM_TaskMoves(benchmark::State& state) {
+    Payload payload{1, 2, 3, 4};
+    uint64_t sum = 0;
+    uint64_t start = spindle::test::global_allocations();
+    for (auto _ : state) {
+        spindle::Task task{[payload, &sum] { sum += payload.a + payload.d; }};
+        spindle::Task queued{std::move(task)};
+        spindle::Task popped{std::move(queued)};
+        popped();
+    }
+    benchmark::DoNotOptimize(sum);
+    report_allocations(state, start, 1);
+}
+BENCHMARK(BM_TaskMoves);
+
+class TaskAllocationFixture : public benchmark::Fixture {
+  public:
+    void SetUp(const benchmark::State& state) override {
+        uint32_t pool_size = state.range(0);
+        thread_pool = std::make_unique<spindle::ThreadPool>(pool_size);
+    }
+
+    void TearDown(const benchmark::State& state) override {
+        thread_pool->tear_down();
+    }
+
+  protected:
+    static constexpr uint32_t num_tasks = 512;
+
+    std::unique_ptr<spindle::ThreadPool> thread_pool;
+};
+
+// Counts allocations on the submission, queueing and execution paths of `ThreadPool`, which should
+// be zero for closures that fit in a `Task`.
+BENCHMARK_DEFINE_F(TaskAllocationFixture, Submit)(benchmark::State& state) {
+    Payload payload{1, 2, 3, 4};
+    uint64_t start = spindle::test::global_allocations();
+    for (auto _ : state) {
+        spindle::Latch latch{num_tasks};
+        for (uint32_t i = 0; i < num_tasks; ++i) {
+            thread_pool->execute([payload, &latch] {
+                benchmark::DoNotOptimize(payload.a + payload.d);
+                latch.decrement();
+            });
+        }
+        latch.wait();
+    }
+    report_allocations(state, start, num_tasks);
+}
+
+BENCHMARK_REGISTER_F(TaskAllocationFixture, Submit)->RangeMultiplier(2)->Range(1, 4); // pool size
@@ -0,0 +1,70 @@
+#include "spindle/task_graph.h"
+
+#include "spindle/thread_pool.h"
+
+#include "benchmark/benchmark.h"
+
+// A wide graph fans out from one node to `num_nodes` independent nodes and joins them again, so it
+// measures how quickly ready nodes spread across the pool. A deep graph is a single chain of
+// `num_nodes` nodes, so it measures the latency of handing a node to its successor.
+class TaskGraphFixture : public benchmark::Fixture {
+  public:
+    void SetUp(const benchmark::State& state) override {
+        thread_pool = std::make_unique<spindle::ThreadPool>(pool_size);
+    }
+
+    void TearDown(const benchmark::State& state) override {
+        thread_pool->tear_down();
+    }
+
+  protected:
+    static constexpr uint32_t pool_size = 4;
+
+    static uint32_t work(uint32_t units) {
+        uint32_t x = units;
+        for (int i = 0; i < units * 64; ++i) {
+            x = (x << 16) | x;
+            x |= 0xBADDECAF;
+            x = (x >> 4) & units;
+        }
+        return x;
+    }
+
+    static spindle::Task node_task() {
+        return [] { benchmark::DoNotOptimize(work(4)); };
+    }
+
+    std::unique_ptr<spindle::ThreadPool> thread_pool;
+};
+
+constexpr uint32_t TaskGraphFixture::pool_size;
+
+BENCHMARK_DEFINE_F(TaskGraphFixture, Wide)(benchmark::State& state) {
+    spindle::TaskGraph graph;
+    auto source = graph.add(node_task());
+    auto sink = graph.add(node_task());
+    for (int i = 0; i < state.range(0); ++i) {
+        graph.add_dependency(sink, graph.add(node_task(), {source}));
+    }
+
+    for (auto _ : state) {
+        graph.run(*thread_pool);
+    }
+    state.SetItemsProcessed(state.iterations() * graph.size());
+}
+
+BENCHMARK_DEFINE_F(TaskGraphFixture, Deep)(benchmark::State& state) {
+    spindle::TaskGraph graph;
+    auto prev = graph.add(node_task());
+    for (int i = 1; i < state.range(0); ++i) {
+        prev = graph.add(node_task(), {prev});
+    }
+
+    for (auto _ : state) {
+        graph.run(*thread_pool);
+    }
+    state.SetItemsProcessed(state.iterations() * graph.size());
+}
+
+BENCHMARK_REGISTER_F(TaskGraphFixture, Wide)->RangeMultiplier(8)->Range(8, 4096);
+BENCHMARK_REGISTER_F(TaskGraphFixture, Deep)->RangeMultiplier(8)->Range(8, 4096);
@@ -0,0 +1,50 @@
+#include "spindle/task_group.h"
+
+#include "spindle/thread_pool.h"
+
+#include "benchmark/benchmark.h"
+
+// Naive recursive Fibonacci, forking at every level above a sequential cutoff. Each level waits on
+// a `TaskGroup`, so the benchmark measures the overhead of nested fork-join and of helping.
+class TaskGroupFixture : public benchmark::Fixture {
+  public:
+    void SetUp(const benchmark::State& state) override {
+        uint32_t pool_size = state.range(0);
+        thread_pool = std::make_unique<spindle::ThreadPool>(pool_size);
+    }
+
+    void TearDown(const benchmark::State& state) override {
+        thread_pool->tear_down();
+    }
+
+  protected:
+    static constexpr uint32_t n = 30;
+    static constexpr uint32_t cutoff = 16;
+
+    static uint64_t fib(uint32_t n) {
+        return n < 2 ? n : fib(n - 1) + fib(n - 2);
+    }
+
+    uint64_t parallel_fib(uint32_t n) {
+        if (n < cutoff) return fib(n);
+        uint64_t a;
+        uint64_t b;
+        spindle::TaskGroup group{*thread_pool};
+        group.run([this, n, &a] { a = parallel_fib(n - 1); });
+        group.run_and_wait([this, n, &b] { b = parallel_fib(n - 2); });
+        return a + b;
+    }
+
+    std::unique_ptr<spindle::ThreadPool> thread_pool;
+};
+
+BENCHMARK_DEFINE_F(TaskGroupFixture, Fib)(benchmark::State& state) {
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(parallel_fib(n));
+    }
+}
+
+BENCHMARK_REGISTER_F(TaskGroupFixture, Fib)
+    ->Unit(benchmark::kMillisecond)
+    ->RangeMultiplier(2)
+    ->Range(1, 8);
@@ -1,5 +1,8 @@
 #include "spindle/thread_pool.h"
 
+#include <atomic>
+#include <functional>
+
 #include "spindle/latch.h"
 
 #include "benchmark/benchmark.h"
@@ -52,3 +55,148 @@ BENCHMARK_REGISTER_F(ThreadPoolFixture, ProcessingTest)
         {1, 32},            // pool size
         {1 << 10, 32 << 10} // number of tasks
     });
+
+// Same as `ThreadPoolFixture`, but the pool dispatches tasks according to the third argument.
+class DispatchFixture : public ThreadPoolFixture {
+  public:
+    void SetUp(const benchmark::State& state) override {
+        if (state.thread_index() != 0) return;
+        spindle::ThreadPoolOptions options;
+        options.num_threads = state.range(0);
+        options.dispatch_policy = static_cast<spindle::DispatchPolicy>(state.range(2));
+        thread_pool = std::make_unique<spindle::ThreadPool>(options);
+    }
+};
+
+// Submits tasks of which one in eight is 16 times longer than the others, so that round-robin
+// dispatch leaves some threads with much longer backlogs than others.
+BENCHMARK_DEFINE_F(DispatchFixture, SkewedProcessingTest)(benchmark::State& state) {
+    uint32_t x = 0;
+    for (auto _ : state) {
+        uint32_t num_tasks = state.range(1);
+        spindle::Latch latch{num_tasks};
+        for (int i = 0; i < num_tasks; ++i) {
+            int rounds = i % 8 == 0 ? 16 : 1;
+            thread_pool->execute([x, rounds, &latch] {
+                for (int r = 0; r < rounds; ++r) {
+                    benchmark::DoNotOptimize(work(123 * x + 19));
+                }
+                latch.decrement();
+            });
+        }
+        latch.wait();
+    }
+}
+
+BENCHMARK_REGISTER_F(DispatchFixture, SkewedProcessingTest)
+    ->ArgNames({"pool", "tasks", "dispatch"})
+    ->ThreadRange(1, 4)
+    ->ArgsProduct({
+        {4, 16},            // pool size
+        {1 << 10, 8 << 10}, // number of tasks
+        {0, 1}              // round-robin, two choices
+    });
+
+// Submits tasks of equal length, which shows the cost of sampling queue lengths when there is
+// nothing to balance.
+BENCHMARK_DEFINE_F(DispatchFixture, DispatchTest)(benchmark::State& state) {
+    uint32_t x = 0;
+    for (auto _ : state) {
+        uint32_t num_tasks = state.range(1);
+        spindle::Latch latch{num_tasks};
+        for (int i = 0; i < num_tasks; ++i) {
+            thread_pool->execute([x, &latch] {
+                benchmark::DoNotOptimize(work(123 * x + 19));
+                latch.decrement();
+            });
+        }
+        latch.wait();
+    }
+}
+
+BENCHMARK_REGISTER_F(DispatchFixture, DispatchTest)
+    ->ArgNames({"pool", "tasks", "dispatch"})
+    ->ThreadRange(1, 16)
+    ->ArgsProduct({
+        {4, 16},            // pool size
+        {1 << 10, 8 << 10}, // number of tasks
+        {0, 1}              // round-robin, two choices
+    });
+
+BENCHMARK_DEFINE_F(ThreadPoolFixture, BulkProcessingTest)(benchmark::State& state) {
+    uint32_t x = 0;
+    for (auto _ : state) {
+        uint32_t num_tasks = state.range(1);
+        spindle::Latch latch{num_tasks};
+        std::vector<spindle::Task> tasks;
+        tasks.reserve(num_tasks);
+        for (int i = 0; i < num_tasks; ++i) {
+            tasks.emplace_back([x, &latch] {
+                benchmark::DoNotOptimize(work(123 * x + 19));
+                latch.decrement();
+            });
+        }
+        thread_pool->execute_bulk(tasks.data(), tasks.data() + tasks.size());
+        latch.wait();
+    }
+}
+
+BENCHMARK_REGISTER_F(ThreadPoolFixture, BulkProcessingTest)
+    ->ThreadRange(1, 16)
+    ->Ranges({
+        {1, 32},            // pool size
+        {1 << 10, 32 << 10} // number of tasks
+    });
+
+// Measures the round trip of a single task submitted to an idle pool, which is dominated by how
+// quickly a waiting thread wakes up.
+static void BM_WakeupLatency(benchmark::State& state) {
+    spindle::ThreadPoolOptions options;
+    options.num_threads = state.range(0);
+    options.wait_strategy = static_cast<spindle::WaitStrategy>(state.range(1));
+    spindle::ThreadPool pool{options};
+    for (auto _ : state) {
+        spindle::Latch latch{};
+        pool.execute([&latch] { latch.decrement(); });
+        latch.wait();
+    }
+}
+
+BENCHMARK(BM_WakeupLatency)
+    ->ArgNames({"threads", "strategy"})
+    ->ArgsProduct({
+        {1, 4},   // pool size
+        {0, 1, 2} // park, adaptive, spin
+    });
+
+// Measures the round trip of a critical task submitted to a pool that is saturated with background
+// tasks.
+static void BM_CriticalLatencyUnderLoad(benchmark::State& state) {
+    spindle::ThreadPool pool{static_cast<uint32_t>(state.range(0))};
+    std::atomic_bool done{};
+    std::function<void()> background = [&] {
+        for (int i = 0; i < 1024; ++i) {
+            benchmark::DoNotOptimize(i);
+        }
+        if (!done) pool.execute(background, spindle::Priority::background);
+    };
+    for (int i = 0; i < 4 * pool.size(); ++i) {
+        pool.execute(background, spindle::Priority::background);
+    }
+
+    for (auto _ : state) {
+        spindle::Latch latch{};
+        pool.execute([&latch] { latch.decrement(); },
+                     static_cast<spindle::Priority>(state.range(1)));
+        latch.wait();
+    }
+    done = true;
+    pool.drain();
+}
+
+BENCHMARK(BM_CriticalLatencyUnderLoad)
+    ->ArgNames({"threads", "priority"})
+    ->ArgsProduct({
+        {1, 4}, // pool size
+        {0, 2}  // critical, background
+    });
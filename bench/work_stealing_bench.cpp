@@ -0,0 +1,79 @@
+#include "spindle/thread_pool.h"
+
+#include "spindle/latch.h"
+
+#include "benchmark/benchmark.h"
+
+// Both benchmarks submit batches with the same total amount of work. In the skewed batch, every
+// task that round-robin dispatch places on the first worker is much more expensive than the rest,
+// so the batch only finishes as fast as the uniform one if idle workers steal the queued tasks.
+class WorkStealingFixture : public benchmark::Fixture {
+  public:
+    void SetUp(const benchmark::State& state) override {
+        uint32_t pool_size = state.range(0);
+        thread_pool = std::make_unique<spindle::ThreadPool>(pool_size);
+    }
+
+    void TearDown(const benchmark::State& state) override {
+        thread_pool->tear_down();
+    }
+
+  protected:
+    // Average cost of a task, in units of `work`.
+    static constexpr uint32_t avg_cost = 8;
+    static constexpr uint32_t num_tasks = 256;
+
+    static uint32_t work(uint32_t units) {
+        uint32_t x = units;
+        for (uint32_t i = 0; i < units * 1024; ++i) {
+            x = (x << 16) | x;
+            x |= 0xBADDECAF;
+            x = (x >> 4) & units;
+        }
+        return x;
+    }
+
+    void run_batch(benchmark::State& state, uint32_t (*cost)(uint32_t, uint32_t)) {
+        uint32_t pool_size = state.range(0);
+        for (auto _ : state) {
+            spindle::Latch latch{num_tasks};
+            for (uint32_t i = 0; i < num_tasks; ++i) {
+                uint32_t units = cost(i, pool_size);
+                thread_pool->execute([units, &latch] {
+                    benchmark::DoNotOptimize(work(units));
+                    latch.decrement();
+                });
+            }
+            latch.wait();
+        }
+    }
+
+    static uint32_t uniform_cost(uint32_t, uint32_t) {
+        return avg_cost;
+    }
+
+    static uint32_t skewed_cost(uint32_t idx, uint32_t pool_size) {
+        // One task per round of `pool_size` tasks carries almost all of the round's work.
+        return idx % pool_size == 0 ? avg_cost * pool_size - (pool_size - 1) : 1;
+    }
+
+    std::unique_ptr<spindle::ThreadPool> thread_pool;
+};
+
+BENCHMARK_DEFINE_F(WorkStealingFixture, UniformCost)(benchmark::State& state) {
+    run_batch(state, uniform_cost);
+}
+
+BENCHMARK_DEFINE_F(WorkStealingFixture, SkewedCost)(benchmark::State& state) {
+    run_batch(state, skewed_cost);
+}
+
+BENCHMARK_REGISTER_F(WorkStealingFixture, UniformCost)
+    ->Unit(benchmark::kMillisecond)
+    ->RangeMultiplier(2)
+    ->Range(1, 8); // pool size
+
+BENCHMARK_REGISTER_F(WorkStealingFixture, SkewedCost)
+    ->Unit(benchmark::kMillisecond)
+    ->RangeMultiplier(2)
+    ->Range(1, 8); // pool size
@@ -44,27 +44,24 @@ int main(int argc, char** argv) {
 
     spindle::ThreadPool thread_pool{pool_size};
     std::vector<short> primes(search_range_max);
-    std::vector<long> durations(num_chunks);
 
     auto start = clock::now();
-    auto fn = [&primes, &durations](int range_min, uint32_t idx) {
+    auto fn = [&primes](int range_min) -> long {
         auto start = clock::now();
         for (int num = range_min; num < range_min + chunk_sz; num++) {
             primes[num] = is_prime(num) ? 1 : 0;
         }
         clock::duration duration = clock::now() - start;
-        long duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
-        durations[idx] = duration_ms;
+        return std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
     };
 
     // Iterate over the range [search_range_min, search_range_max] in steps of chunk_sz.
-    int idx = 0;
+    std::vector<spindle::Future<long>> futures;
     for (int range_min = search_range_min; range_min <= search_range_max; range_min += chunk_sz) {
-        thread_pool.execute([&fn, range_min, idx] { fn(range_min, idx); });
-        idx++;
+        futures.push_back(thread_pool.submit([&fn, range_min] { return fn(range_min); }));
     }
 
-    thread_pool.drain();
+    std::vector<long> durations = spindle::when_all(std::move(futures)).get();
     clock::duration duration = clock::now() - start;
 
     std::cout << "Duration (ms)\n";
@@ -0,0 +1,43 @@
+#ifndef SPINDLE_BARRIER_H_
+#define SPINDLE_BARRIER_H_
+
+#include <atomic>
+#include <cstdint>
+
+namespace spindle {
+
+// `Barrier` blocks a group of threads until all of them have arrived at it. Once the last thread
+// arrives, all of them are unblocked and the `Barrier` resets for the next phase, so the same
+// group can synchronize on it repeatedly. Arriving never takes a lock, and only the last thread to
+// arrive enters the kernel, and only if other threads are blocked.
+class Barrier {
+  public:
+    // Creates a `Barrier` for a group of `count` threads, which must be positive.
+    explicit Barrier(uint32_t count);
+
+    Barrier(const Barrier&) = delete;
+    Barrier& operator=(const Barrier&) = delete;
+
+    // Arrives at the `Barrier` and blocks until all threads of the group have arrived in the
+    // current phase.
+    void arrive_and_wait();
+    // Arrives at the `Barrier` without blocking, and leaves the group for the following phases.
+    void arrive_and_drop();
+
+  private:
+    // Set in `phase` once a thread blocks in the current phase. The remaining bits count phases.
+    static constexpr uint32_t waiting = 1;
+
+    // Threads that have yet to arrive in the current phase.
+    std::atomic_uint32_t remaining;
+    // Threads in the group for the next phase.
+    std::atomic_uint32_t expected;
+    std::atomic_uint32_t phase{0};
+
+    // Returns true if the calling thread was the last to arrive.
+    bool arrive(uint32_t p, bool drop);
+};
+
+} // namespace spindle
+
+#endif // SPINDLE_BARRIER_H_
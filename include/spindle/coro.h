@@ -0,0 +1,377 @@
+#ifndef SPINDLE_CORO_H_
+#define SPINDLE_CORO_H_
+
+#if __cplusplus < 202002L || !defined(__cpp_impl_coroutine)
+#error "spindle/coro.h requires C++20 coroutines; link against the spindle-coro target"
+#endif
+
+#include <chrono>
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "spindle/future.h"
+#include "spindle/thread_pool.h"
+
+namespace spindle {
+
+template <class T = void>
+class CoTask;
+
+namespace detail {
+
+// `Trampoline` resumes coroutines that transfer control to each other one after the other, instead
+// of nesting their activations on the stack, since compilers only turn symmetric transfer into a
+// tail call when optimizing.
+class Trampoline {
+  public:
+    // Resumes `h` on the calling thread, and then every coroutine it transfers control to, until
+    // none is left to resume.
+    static void run(std::coroutine_handle<> h) {
+        bool outer = std::exchange(active, true);
+        std::coroutine_handle<> outer_next = std::exchange(next, h);
+        while (std::coroutine_handle<> n = std::exchange(next, {})) {
+            n.resume();
+        }
+        next = outer_next;
+        active = outer;
+    }
+
+    // Returns the coroutine that `await_suspend` hands control to in order to resume `h`. Outside
+    // `run`, this is `h` itself, which leaves the transfer to the compiler.
+    static std::coroutine_handle<> transfer(std::coroutine_handle<> h) noexcept {
+        if (!active || next) return h;
+        next = h;
+        return std::noop_coroutine();
+    }
+
+  private:
+    static inline thread_local bool active{false};
+    static inline thread_local std::coroutine_handle<> next{};
+};
+
+class CoTaskPromiseBase {
+  public:
+    std::suspend_always initial_suspend() noexcept {
+        return {};
+    }
+
+    // Transfers control to the awaiting coroutine without growing the stack.
+    struct FinalAwaiter {
+        bool await_ready() noexcept {
+            return false;
+        }
+
+        template <class P>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<P> h) noexcept {
+            return Trampoline::transfer(h.promise().continuation);
+        }
+
+        void await_resume() noexcept {}
+    };
+
+    FinalAwaiter final_suspend() noexcept {
+        return {};
+    }
+
+    void unhandled_exception() noexcept {
+        error = std::current_exception();
+    }
+
+    void set_continuation(std::coroutine_handle<> h, std::coroutine_handle<> owner) noexcept {
+        continuation = h;
+        root = owner;
+    }
+
+    // Returns the coroutine started by `spawn` or `sync_wait` that awaits this one through a chain
+    // of `CoTask`s, or null if the chain was started some other way.
+    std::coroutine_handle<> owner() const noexcept {
+        return root;
+    }
+
+  protected:
+    std::coroutine_handle<> continuation{std::noop_coroutine()};
+    std::coroutine_handle<> root{};
+    std::exception_ptr error;
+
+    void rethrow_if_error() {
+        if (error) std::rethrow_exception(error);
+    }
+};
+
+template <class T>
+class CoTaskPromise : public CoTaskPromiseBase {
+  public:
+    CoTask<T> get_return_object() noexcept;
+
+    template <class U>
+    void return_value(U&& v) {
+        value.emplace(std::forward<U>(v));
+    }
+
+    T result() {
+        rethrow_if_error();
+        return std::move(*value);
+    }
+
+  private:
+    std::optional<T> value;
+};
+
+template <>
+class CoTaskPromise<void> : public CoTaskPromiseBase {
+  public:
+    CoTask<void> get_return_object() noexcept;
+
+    void return_void() noexcept {}
+
+    void result() {
+        rethrow_if_error();
+    }
+};
+
+// `Detached` is a coroutine that starts once `handle` is resumed, and frees itself once it
+// completes.
+struct Detached {
+    struct promise_type {
+        Detached get_return_object() noexcept {
+            return {std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+
+        std::suspend_always initial_suspend() noexcept {
+            return {};
+        }
+
+        std::suspend_never final_suspend() noexcept {
+            return {};
+        }
+
+        void return_void() noexcept {}
+
+        void unhandled_exception() noexcept {
+            std::terminate();
+        }
+    };
+
+    std::coroutine_handle<> handle;
+};
+
+// Returns the coroutine that owns the suspended coroutine `h`, which is `h` itself if it is started
+// by `spawn` or `sync_wait`.
+template <class P>
+std::coroutine_handle<> owner_of(std::coroutine_handle<P> h) noexcept {
+    if constexpr (std::is_base_of<CoTaskPromiseBase, P>::value) {
+        return h.promise().owner();
+    } else if constexpr (std::is_same<P, Detached::promise_type>::value) {
+        return h;
+    } else {
+        return {};
+    }
+}
+
+// `Resume` is the task that resumes a coroutine suspended on a `ThreadPool`. If the pool drops it
+// without running it, which `ThreadPool::tear_down` does to queued tasks, the `Resume` destroys
+// the coroutine that owns the suspended one, along with the chain of `CoTask`s it awaits, so that
+// the `Future` of `spawn` or `sync_wait` holds a `std::future_error` with the `broken_promise`
+// code instead of never becoming ready. Coroutines not started by either of them stay suspended.
+class Resume {
+  public:
+    Resume(Resume&& other) noexcept : h(std::exchange(other.h, {})), owner(other.owner) {}
+    Resume& operator=(Resume&&) = delete;
+
+    ~Resume() {
+        // A `Resume` that the pool rejects is destroyed before `hand_over` returns, and the
+        // coroutine continues on the thread that suspended it.
+        if (h && owner && h.address() != handing_over) owner.destroy();
+    }
+
+    void operator()() {
+        Trampoline::run(std::exchange(h, {}));
+    }
+
+    // Passes a `Resume` for `h` to `schedule`, and returns whether `schedule` accepted it.
+    template <class P, class F>
+    static bool hand_over(std::coroutine_handle<P> h, F schedule) {
+        struct Guard {
+            ~Guard() {
+                handing_over = nullptr;
+            }
+        } guard;
+        handing_over = h.address();
+        return schedule(Task{Resume{h, owner_of(h)}});
+    }
+
+  private:
+    Resume(std::coroutine_handle<> h, std::coroutine_handle<> owner) noexcept
+        : h(h), owner(owner) {}
+
+    std::coroutine_handle<> h;
+    std::coroutine_handle<> owner;
+
+    // The coroutine whose `Resume` is being passed to a pool on this thread.
+    static inline thread_local void* handing_over{nullptr};
+};
+
+template <class T>
+struct CoTaskAwaiter {
+    std::coroutine_handle<CoTaskPromise<T>> handle;
+
+    bool await_ready() noexcept {
+        return false;
+    }
+
+    template <class P>
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<P> awaiting) noexcept {
+        handle.promise().set_continuation(awaiting, owner_of(awaiting));
+        return Trampoline::transfer(handle);
+    }
+
+    T await_resume() {
+        return handle.promise().result();
+    }
+};
+
+struct ScheduleAwaiter {
+    ThreadPool* pool;
+
+    bool await_ready() noexcept {
+        return false;
+    }
+
+    // Continues on the calling thread if the task that resumes the coroutine is not queued, so
+    // that the coroutine is never left suspended.
+    template <class P>
+    bool await_suspend(std::coroutine_handle<P> h) {
+        return Resume::hand_over(
+            h, [this](Task resume) { return pool->try_execute(std::move(resume)); });
+    }
+
+    void await_resume() noexcept {}
+};
+
+struct SleepAwaiter {
+    ThreadPool* pool;
+    std::chrono::nanoseconds delay;
+
+    bool await_ready() noexcept {
+        return false;
+    }
+
+    // Sleeps on the calling thread, and continues there, if the pool rejects the timer.
+    template <class P>
+    bool await_suspend(std::coroutine_handle<P> h) {
+        bool scheduled = Resume::hand_over(h, [this](Task resume) {
+            // A delay that has already elapsed would queue the task subject to the overflow
+            // policy, which may run it on this thread before the coroutine has suspended.
+            if (delay <= std::chrono::nanoseconds::zero()) {
+                return pool->try_execute(std::move(resume));
+            }
+            return static_cast<bool>(pool->execute_after(std::move(resume), delay));
+        });
+        if (!scheduled) std::this_thread::sleep_for(delay);
+        return scheduled;
+    }
+
+    void await_resume() noexcept {}
+};
+
+template <class T>
+Detached fulfil(ThreadPool* pool, CoTask<T> task, Promise<T> promise) {
+    try {
+        if (pool != nullptr) co_await pool->schedule();
+        if constexpr (std::is_void<T>::value) {
+            co_await std::move(task);
+            promise.set_value();
+        } else {
+            promise.set_value(co_await std::move(task));
+        }
+    } catch (...) {
+        promise.set_exception(std::current_exception());
+    }
+}
+
+} // namespace detail
+
+// `CoTask` is a coroutine that produces a value of type `T`. It is lazy: its body does not start
+// until the `CoTask` is awaited, and the awaiting coroutine is resumed by symmetric transfer once
+// the body completes, so chains of awaits neither block threads nor grow the stack. Exceptions
+// thrown by the body are rethrown to the awaiting coroutine. Each `CoTask` allocates its coroutine
+// frame once. Hops onto a `ThreadPool` through `ThreadPool::schedule` and `ThreadPool::sleep_for`
+// do not allocate.
+template <class T>
+class [[nodiscard]] CoTask {
+  public:
+    using promise_type = detail::CoTaskPromise<T>;
+
+    CoTask(CoTask&& other) noexcept : handle(std::exchange(other.handle, {})) {}
+
+    CoTask& operator=(CoTask&& other) noexcept {
+        if (this != &other) {
+            if (handle) handle.destroy();
+            handle = std::exchange(other.handle, {});
+        }
+        return *this;
+    }
+
+    CoTask(const CoTask&) = delete;
+    CoTask& operator=(const CoTask&) = delete;
+
+    ~CoTask() {
+        if (handle) handle.destroy();
+    }
+
+    auto operator co_await() && noexcept {
+        return detail::CoTaskAwaiter<T>{handle};
+    }
+
+  private:
+    friend promise_type;
+
+    explicit CoTask(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+template <class T>
+CoTask<T> detail::CoTaskPromise<T>::get_return_object() noexcept {
+    return CoTask<T>{std::coroutine_handle<CoTaskPromise>::from_promise(*this)};
+}
+
+inline CoTask<void> detail::CoTaskPromise<void>::get_return_object() noexcept {
+    return CoTask<void>{std::coroutine_handle<CoTaskPromise>::from_promise(*this)};
+}
+
+inline auto operator co_await(ThreadPool::ScheduleOperation op) noexcept {
+    return detail::ScheduleAwaiter{op.pool};
+}
+
+inline auto operator co_await(ThreadPool::SleepOperation op) noexcept {
+    return detail::SleepAwaiter{op.pool, op.delay};
+}
+
+// Starts `task` on a thread of `pool`, and returns a `Future` for its result. Continuations
+// attached to the `Future` run on `pool`.
+template <class T>
+Future<T> spawn(ThreadPool& pool, CoTask<T> task) {
+    Promise<T> promise{&pool};
+    Future<T> future = promise.get_future();
+    detail::Trampoline::run(detail::fulfil(&pool, std::move(task), std::move(promise)).handle);
+    return future;
+}
+
+// Runs `task` on the calling thread until it first suspends, and then blocks until it completes.
+// Returns its result, or rethrows the exception it threw.
+template <class T>
+T sync_wait(CoTask<T> task) {
+    Promise<T> promise;
+    Future<T> future = promise.get_future();
+    detail::Trampoline::run(detail::fulfil(nullptr, std::move(task), std::move(promise)).handle);
+    return future.get();
+}
+
+} // namespace spindle
+
+#endif // SPINDLE_CORO_H_
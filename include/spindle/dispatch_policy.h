@@ -0,0 +1,20 @@
+#ifndef SPINDLE_DISPATCH_POLICY_H_
+#define SPINDLE_DISPATCH_POLICY_H_
+
+namespace spindle {
+
+// `DispatchPolicy` determines on which thread of a `ThreadPool` a task submitted from outside the
+// pool is queued.
+enum class DispatchPolicy {
+    // Take turns, which spreads tasks evenly but ignores how much work each thread already has,
+    // and makes every submitting thread update the same counter.
+    round_robin,
+    // Sample two threads at random and pick the one with less work, which keeps the backlogs
+    // balanced when tasks vary in length. Each submitting thread draws from a generator of its own,
+    // so submitting threads share no state.
+    two_choices,
+};
+
+} // namespace spindle
+
+#endif // SPINDLE_DISPATCH_POLICY_H_
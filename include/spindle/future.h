@@ -0,0 +1,517 @@
+#ifndef SPINDLE_FUTURE_H_
+#define SPINDLE_FUTURE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <future>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "spindle/latch.h"
+#include "spindle/task.h"
+
+namespace spindle {
+
+class ThreadPool;
+
+template <class T>
+class Future;
+
+template <class T>
+class Promise;
+
+namespace detail {
+
+// Schedules `task` on `pool`, or runs it on the calling thread if `pool` is null.
+void schedule(ThreadPool* pool, Task task);
+
+template <class T>
+class Storage {
+  public:
+    ~Storage() {
+        if (has_value) get().~T();
+    }
+
+    template <class U>
+    void emplace(U&& value) {
+        ::new (&buf) T(std::forward<U>(value));
+        has_value = true;
+    }
+
+    T take() {
+        return std::move(get());
+    }
+
+  private:
+    alignas(T) unsigned char buf[sizeof(T)];
+    bool has_value{};
+
+    T& get() {
+        return *reinterpret_cast<T*>(&buf);
+    }
+};
+
+template <>
+class Storage<void> {
+  public:
+    void emplace() {}
+    void take() {}
+};
+
+// `SharedState` is the state shared by a `Promise` and its `Future`. It is a single, reference
+// counted allocation, and completion is signalled through an atomic status word instead of a mutex
+// and condition variable. A single continuation can be attached, which runs once a value or an
+// exception is set.
+template <class T>
+class SharedState {
+  public:
+    explicit SharedState(ThreadPool* pool) : pool(pool) {}
+
+    template <class... A>
+    void set_value(A&&... value) {
+        storage.emplace(std::forward<A>(value)...);
+        complete();
+    }
+
+    void set_exception(std::exception_ptr e) {
+        exception = std::move(e);
+        complete();
+    }
+
+    // Returns the value, or rethrows the exception. Only valid once the state is ready.
+    T take() {
+        if (exception) std::rethrow_exception(exception);
+        return storage.take();
+    }
+
+    bool ready() const {
+        return status.load(std::memory_order_acquire) == status_ready;
+    }
+
+    // Attaches `continuation`, which runs on the completing thread if `run_inline` is set, or on
+    // `pool` otherwise. It runs immediately if the state is already ready.
+    void on_ready(Task continuation, bool run_inline) {
+        cont = std::move(continuation);
+        cont_inline = run_inline;
+        uint8_t expected = status_pending;
+        if (status.compare_exchange_strong(expected, status_attached, std::memory_order_acq_rel)) {
+            return;
+        }
+        fire();
+    }
+
+    void retain() {
+        refs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void release() {
+        if (refs.fetch_sub(1, std::memory_order_acq_rel) == 1) delete this;
+    }
+
+    ThreadPool* const pool;
+    std::exception_ptr exception;
+
+  private:
+    static constexpr uint8_t status_pending = 0;
+    static constexpr uint8_t status_attached = 1;
+    static constexpr uint8_t status_ready = 2;
+
+    std::atomic<uint32_t> refs{1};
+    std::atomic<uint8_t> status{status_pending};
+    Task cont;
+    bool cont_inline{};
+    Storage<T> storage;
+
+    void complete() {
+        if (status.exchange(status_ready, std::memory_order_acq_rel) == status_attached) fire();
+    }
+
+    void fire() {
+        // The continuation may drop the last reference to this state, so it must not run in place.
+        Task task{std::move(cont)};
+        if (cont_inline) {
+            task();
+        } else {
+            schedule(pool, std::move(task));
+        }
+    }
+};
+
+// Owns one reference to a `SharedState`.
+template <class T>
+class Ref {
+  public:
+    explicit Ref(SharedState<T>* state) : state(state) {}
+    Ref(Ref&& other) noexcept : state(other.state) {
+        other.state = nullptr;
+    }
+    Ref(const Ref&) = delete;
+    ~Ref() {
+        if (state != nullptr) state->release();
+    }
+
+    SharedState<T>* operator->() const {
+        return state;
+    }
+
+  private:
+    SharedState<T>* state;
+};
+
+template <class T, class F>
+struct ThenResult {
+    using type = decltype(std::declval<F&>()(std::declval<T>()));
+};
+
+template <class F>
+struct ThenResult<void, F> {
+    using type = decltype(std::declval<F&>()());
+};
+
+template <class R>
+struct Fulfil {
+    template <class F, class... A>
+    static void run(Promise<R>& promise, F& f, A&&... args) {
+        promise.set_value(f(std::forward<A>(args)...));
+    }
+};
+
+template <>
+struct Fulfil<void> {
+    // `P` is always `Promise<void>`, which is incomplete at this point.
+    template <class P, class F, class... A>
+    static void run(P& promise, F& f, A&&... args) {
+        f(std::forward<A>(args)...);
+        promise.set_value();
+    }
+};
+
+// Invokes `f` and fulfils `promise` with its result, or with the exception it throws.
+template <class R, class F, class... A>
+void fulfil(Promise<R>& promise, F& f, A&&... args) {
+    try {
+        Fulfil<R>::run(promise, f, std::forward<A>(args)...);
+    } catch (...) {
+        promise.set_exception(std::current_exception());
+    }
+}
+
+template <class T>
+struct Continue {
+    template <class R, class F>
+    static void run(Ref<T>& in, Promise<R>& promise, F& f) {
+        if (in->exception) {
+            promise.set_exception(in->exception);
+        } else {
+            fulfil(promise, f, in->take());
+        }
+    }
+};
+
+template <>
+struct Continue<void> {
+    template <class R, class F>
+    static void run(Ref<void>& in, Promise<R>& promise, F& f) {
+        if (in->exception) {
+            promise.set_exception(in->exception);
+        } else {
+            fulfil(promise, f);
+        }
+    }
+};
+
+template <class T>
+struct WhenAll;
+
+template <class T>
+struct WhenAny;
+
+} // namespace detail
+
+// `Future` holds the result of an asynchronous operation: either a value or the exception that the
+// operation threw. A `Future` is move-only and its result can be consumed once, either by blocking
+// on `get` or by attaching a continuation with `then`.
+template <class T>
+class Future {
+  public:
+    // Creates a `Future` without a shared state.
+    Future() noexcept = default;
+
+    Future(Future&& other) noexcept : state(other.state) {
+        other.state = nullptr;
+    }
+
+    Future& operator=(Future&& other) noexcept {
+        if (this != &other) {
+            if (state != nullptr) state->release();
+            state = other.state;
+            other.state = nullptr;
+        }
+        return *this;
+    }
+
+    Future(const Future&) = delete;
+    Future& operator=(const Future&) = delete;
+
+    ~Future() {
+        if (state != nullptr) state->release();
+    }
+
+    // Returns true if the `Future` refers to a shared state, i.e. it was obtained from a `Promise`
+    // or `ThreadPool::submit` and its result has not been consumed yet.
+    bool valid() const noexcept {
+        return state != nullptr;
+    }
+
+    // Returns true if the result is available.
+    bool is_ready() const {
+        return state->ready();
+    }
+
+    // Blocks the calling thread until the result is available.
+    void wait() const {
+        if (state->ready()) return;
+        Latch latch{};
+        state->on_ready([&latch] { latch.decrement(); }, true);
+        latch.wait();
+    }
+
+    // Blocks until the result is available and returns it, or rethrows the exception that the
+    // operation threw. The `Future` is no longer valid afterwards.
+    T get() {
+        wait();
+        detail::Ref<T> ref{state};
+        state = nullptr;
+        return ref->take();
+    }
+
+    // Attaches a continuation that is invoked with the value of this `Future` once it is available,
+    // and returns a `Future` for the result of the continuation. The continuation runs on the
+    // `ThreadPool` that produces this `Future`, without blocking any of its threads. If this
+    // `Future` holds an exception, the continuation is skipped and the exception is propagated to
+    // the returned `Future`. This `Future` is no longer valid afterwards.
+    template <class F, class R = typename detail::ThenResult<T, typename std::decay<F>::type>::type>
+    Future<R> then(F&& f) {
+        detail::Ref<T> in{state};
+        state = nullptr;
+        Promise<R> promise{in->pool};
+        Future<R> out = promise.get_future();
+        detail::SharedState<T>* s = in.operator->();
+        s->on_ready(
+            [in = std::move(in), promise = std::move(promise), f = std::forward<F>(f)]() mutable {
+                detail::Continue<T>::run(in, promise, f);
+            },
+            false);
+        return out;
+    }
+
+  private:
+    explicit Future(detail::SharedState<T>* state) : state(state) {}
+
+    detail::SharedState<T>* state{};
+
+    friend Promise<T>;
+    friend detail::WhenAll<T>;
+    friend detail::WhenAny<T>;
+};
+
+// `Promise` is the producing end of a `Future`. Continuations attached to the `Future` run on the
+// `ThreadPool` passed to the constructor, or on the thread that fulfils the `Promise` if there is
+// none. Destroying a `Promise` that was not fulfilled stores a `std::future_error` with the
+// `broken_promise` error code in the `Future`.
+template <class T>
+class Promise {
+  public:
+    explicit Promise(ThreadPool* pool = nullptr) : state(new detail::SharedState<T>{pool}) {}
+
+    Promise(Promise&& other) noexcept : state(other.state), fulfilled(other.fulfilled) {
+        other.state = nullptr;
+    }
+
+    Promise(const Promise&) = delete;
+    Promise& operator=(const Promise&) = delete;
+
+    ~Promise() {
+        if (state == nullptr) return;
+        if (!fulfilled) {
+            state->set_exception(
+                std::make_exception_ptr(std::future_error{std::future_errc::broken_promise}));
+        }
+        state->release();
+    }
+
+    // Returns the `Future` associated with this `Promise`. Must be called at most once.
+    Future<T> get_future() {
+        state->retain();
+        return Future<T>{state};
+    }
+
+    template <class... A>
+    void set_value(A&&... value) {
+        fulfilled = true;
+        state->set_value(std::forward<A>(value)...);
+    }
+
+    void set_exception(std::exception_ptr e) {
+        fulfilled = true;
+        state->set_exception(std::move(e));
+    }
+
+  private:
+    detail::SharedState<T>* state;
+    bool fulfilled{};
+};
+
+namespace detail {
+
+template <class T>
+struct WhenAllResult {
+    using type = std::vector<T>;
+};
+
+template <>
+struct WhenAllResult<void> {
+    using type = void;
+};
+
+template <class T>
+struct WhenAnyResult {
+    using type = std::pair<size_t, T>;
+};
+
+template <>
+struct WhenAnyResult<void> {
+    using type = size_t;
+};
+
+// Tracks the inputs of `when_all`. The last input to complete fulfils the promise.
+template <class T>
+struct WhenAll {
+    using Result = typename WhenAllResult<T>::type;
+
+    explicit WhenAll(std::vector<Future<T>> futures)
+        : inputs(std::move(futures)), remaining(inputs.size() + 1), promise(pool_of(inputs)) {}
+
+    // Continuations of the combined `Future` run on the pool of the first input.
+    static ThreadPool* pool_of(const std::vector<Future<T>>& futures) {
+        for (auto&& future : futures) {
+            if (!future.valid()) throw std::runtime_error{"Cannot combine an invalid future"};
+        }
+        return futures.empty() ? nullptr : futures[0].state->pool;
+    }
+
+    std::vector<Future<T>> inputs;
+    std::atomic<size_t> remaining;
+    Promise<Result> promise;
+
+    Future<Result> start() {
+        Future<Result> result = promise.get_future();
+        for (auto&& input : inputs) {
+            input.state->on_ready([this] { notify(); }, true);
+        }
+        // Accounts for the extra count that keeps this object alive while attaching.
+        notify();
+        return result;
+    }
+
+    void notify() {
+        if (--remaining > 0) return;
+        try {
+            collect(std::is_void<T>{});
+        } catch (...) {
+            promise.set_exception(std::current_exception());
+        }
+        delete this;
+    }
+
+    void collect(std::false_type) {
+        Result values;
+        values.reserve(inputs.size());
+        for (auto&& input : inputs) {
+            values.push_back(input.get());
+        }
+        promise.set_value(std::move(values));
+    }
+
+    void collect(std::true_type) {
+        for (auto&& input : inputs) {
+            input.get();
+        }
+        promise.set_value();
+    }
+};
+
+// Tracks the inputs of `when_any`. The first input to complete fulfils the promise, and the last
+// one releases this object.
+template <class T>
+struct WhenAny {
+    using Result = typename WhenAnyResult<T>::type;
+
+    explicit WhenAny(std::vector<Future<T>> futures)
+        : inputs(std::move(futures)),
+          remaining(inputs.size() + 1),
+          promise(WhenAll<T>::pool_of(inputs)) {}
+
+    std::vector<Future<T>> inputs;
+    std::atomic<size_t> remaining;
+    std::atomic_bool done{};
+    Promise<Result> promise;
+
+    Future<Result> start() {
+        Future<Result> result = promise.get_future();
+        for (size_t i = 0; i < inputs.size(); ++i) {
+            inputs[i].state->on_ready([this, i] { notify(i); }, true);
+        }
+        release();
+        return result;
+    }
+
+    void notify(size_t idx) {
+        if (!done.exchange(true)) {
+            try {
+                resolve(idx, std::is_void<T>{});
+            } catch (...) {
+                promise.set_exception(std::current_exception());
+            }
+        }
+        release();
+    }
+
+    void resolve(size_t idx, std::false_type) {
+        promise.set_value(Result{idx, inputs[idx].get()});
+    }
+
+    void resolve(size_t idx, std::true_type) {
+        inputs[idx].get();
+        promise.set_value(idx);
+    }
+
+    void release() {
+        if (--remaining == 0) delete this;
+    }
+};
+
+} // namespace detail
+
+// Returns a `Future` that becomes ready once all of `futures` are ready. It holds the values of
+// `futures` in order, or the exception of the first of them, by position, that holds one.
+template <class T>
+Future<typename detail::WhenAllResult<T>::type> when_all(std::vector<Future<T>> futures) {
+    return (new detail::WhenAll<T>{std::move(futures)})->start();
+}
+
+// Returns a `Future` that becomes ready once any of `futures` is ready. It holds the position and
+// the value of the first of `futures` to become ready, or the exception that it holds.
+template <class T>
+Future<typename detail::WhenAnyResult<T>::type> when_any(std::vector<Future<T>> futures) {
+    if (futures.empty()) throw std::runtime_error{"Cannot wait for any of zero futures"};
+    return (new detail::WhenAny<T>{std::move(futures)})->start();
+}
+
+} // namespace spindle
+
+#endif // SPINDLE_FUTURE_H_
@@ -1,8 +1,8 @@
 #ifndef SPINDLE_LATCH_H_
 #define SPINDLE_LATCH_H_
 
-#include <condition_variable>
-#include <mutex>
+#include <atomic>
+#include <cstdint>
 
 namespace spindle {
 
@@ -12,24 +12,38 @@ namespace spindle {
 // operation. Each time such operation is completed successfully, the weight of the `Latch` is
 // decremented by one, and the waiting threads are unblocked once the weight reaches zero. Unlike a
 // semaphore, a `Latch` cannot be reused to block threads once its weight reaches zero.
+//
+// The weight is a single atomic word, so decrementing never takes a lock, and only enters the
+// kernel if a thread is blocked in `wait`. A `Latch` can be destroyed as soon as `wait` returns.
 class Latch {
   public:
+    // The largest weight a `Latch` can have.
+    static constexpr uint32_t max_weight = (uint32_t{1} << 31) - 1;
+
     // Instantiates a `Latch` of weight one.
     Latch();
-    // Instantiates a `Latch` of the given positive weight.
+    // Instantiates a `Latch` of the given positive weight, which must not exceed `max_weight`.
     Latch(uint32_t weight);
 
+    Latch(const Latch&) = delete;
+    Latch& operator=(const Latch&) = delete;
+
     // Decrements the weight of the `Latch` by one.
     // Calling this method when the weight is already zero is a no-op.
     void decrement();
+    // Decrements the weight of the `Latch` by `n`, stopping at zero.
+    void count_down(uint32_t n);
+    // Returns true if the weight of the `Latch` has reached zero.
+    bool try_wait() const;
     // Blocks the calling thread until the weight of the `Latch` reaches zero.
     // Calling this method when the weight is already zero is a no-op.
     void wait();
 
   private:
-    std::condition_variable cv;
-    std::mutex m;
-    uint32_t weight{};
+    // Set in `state` once a thread blocks in `wait`. The remaining bits hold the weight.
+    static constexpr uint32_t waiting = uint32_t{1} << 31;
+
+    std::atomic_uint32_t state;
 };
 
 } // namespace spindle
@@ -0,0 +1,93 @@
+#ifndef SPINDLE_METRICS_H_
+#define SPINDLE_METRICS_H_
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "spindle/priority.h"
+
+namespace spindle {
+
+// `Histogram` counts durations in log-linear buckets: durations below 4ns have a bucket each, and
+// every higher power of two of nanoseconds is split into four buckets of equal width. A bucket is
+// thus at most a quarter as wide as its lower bound, and any duration fits in a fixed number of
+// buckets.
+struct Histogram {
+    static constexpr size_t num_buckets = 248;
+
+    // Returns the bucket into which `value` falls. Negative values count as zero.
+    static size_t bucket(std::chrono::nanoseconds value);
+    // Returns the smallest value that falls into `bucket`.
+    static std::chrono::nanoseconds lower_bound(size_t bucket);
+
+    // Adds `value` to the histogram.
+    void add(std::chrono::nanoseconds value);
+    // Returns the number of values in the histogram.
+    uint64_t count() const;
+    // Returns the smallest bucket bound below which at least a fraction `q` of the values fall,
+    // which overestimates the quantile by at most a quarter. Returns zero if the histogram is
+    // empty.
+    std::chrono::nanoseconds quantile(double q) const;
+    Histogram& operator+=(const Histogram& other);
+
+    std::array<uint64_t, num_buckets> counts{};
+    // Sum of the values in the histogram.
+    std::chrono::nanoseconds sum{};
+};
+
+inline size_t Histogram::bucket(std::chrono::nanoseconds value) {
+    if (value.count() < 4) return value.count() < 0 ? 0 : value.count();
+    uint64_t v = value.count();
+    size_t msb = 63 - __builtin_clzll(v);
+    return (msb - 1) * 4 + ((v >> (msb - 2)) & 3);
+}
+
+// `WorkerMetrics` is a snapshot of the activity of one thread of a `ThreadPool`.
+struct WorkerMetrics {
+    // Immediate tasks waiting in the thread's queues, including pinned ones.
+    uint64_t queued;
+    // Immediate tasks of each `Priority` waiting in the thread's queues, excluding pinned ones.
+    uint64_t queue_depth[num_priorities];
+    // Deferred and periodic tasks waiting for their deadline.
+    uint64_t deferred;
+    // Tasks the thread has run, including stolen and deferred ones.
+    uint64_t executed;
+    // Tasks the thread has stolen from others.
+    uint64_t stolen;
+    // Tasks that found a queue of the thread full, and the queued tasks that were discarded to
+    // make room for them. See `OverflowPolicy`.
+    uint64_t overflowed;
+    uint64_t dropped;
+    // Time the thread has spent looking for and running tasks, and waiting for work. Time spent
+    // while the thread of an elastic pool is retired counts as neither.
+    std::chrono::nanoseconds busy_time;
+    std::chrono::nanoseconds idle_time;
+    // How long the immediate tasks taken from the thread's queues waited, indexed by `Priority`.
+    Histogram queueing_delay[num_priorities];
+};
+
+// `Metrics` is a snapshot of the activity of a `ThreadPool`. Counters are read one at a time
+// while the threads keep running, so a snapshot is only consistent once the pool is quiescent.
+struct Metrics {
+    // Number of threads that are running, which only differs from `workers.size()` if the pool is
+    // elastic.
+    uint32_t threads;
+    std::vector<WorkerMetrics> workers;
+    // Number of immediate tasks of each priority a thread can queue, or zero if there is no limit.
+    uint64_t queue_capacity;
+
+    // Returns how long the immediate tasks of the given priority waited, over all threads.
+    Histogram queueing_delay(Priority priority) const;
+    // Formats the snapshot in the Prometheus text exposition format, with every metric name
+    // starting with `prefix`. Counters and gauges are labeled with the index of their thread, and
+    // queue depths and queueing delay histograms with their priority class.
+    std::string to_prometheus(const std::string& prefix = "spindle") const;
+};
+
+} // namespace spindle
+
+#endif // SPINDLE_METRICS_H_
@@ -0,0 +1,17 @@
+#ifndef SPINDLE_MISSED_RUN_POLICY_H_
+#define SPINDLE_MISSED_RUN_POLICY_H_
+
+namespace spindle {
+
+// `MissedRunPolicy` determines what a task scheduled at a fixed rate does about the runs it missed,
+// because its threads were busy or because a run took longer than the period.
+enum class MissedRunPolicy {
+    // Make up for the missed runs back to back, until the task is on schedule again.
+    catch_up,
+    // Drop the missed runs, and run next at the first point of the schedule that is still ahead.
+    skip,
+};
+
+} // namespace spindle
+
+#endif // SPINDLE_MISSED_RUN_POLICY_H_
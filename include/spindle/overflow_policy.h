@@ -0,0 +1,21 @@
+#ifndef SPINDLE_OVERFLOW_POLICY_H_
+#define SPINDLE_OVERFLOW_POLICY_H_
+
+namespace spindle {
+
+// `OverflowPolicy` determines what `ThreadPool::execute` does with a task that finds the queue of
+// its thread full, which only happens if `ThreadPoolOptions::queue_capacity` is set.
+enum class OverflowPolicy {
+    // Block the submitting thread until the queue has room. A thread of the pool that submits to
+    // its own full queue runs the task instead, as it would otherwise wait on itself.
+    block,
+    // Run the task on the submitting thread, which slows producers down to the pace of the pool.
+    caller_runs,
+    // Discard the oldest task of the queue to make room. Discarded tasks are destroyed without
+    // running, so this only suits tasks that nothing waits on.
+    drop_oldest,
+};
+
+} // namespace spindle
+
+#endif // SPINDLE_OVERFLOW_POLICY_H_
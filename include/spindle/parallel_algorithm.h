@@ -0,0 +1,245 @@
+#ifndef SPINDLE_PARALLEL_ALGORITHM_H_
+#define SPINDLE_PARALLEL_ALGORITHM_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "spindle/parallel_for.h"
+#include "spindle/task_group.h"
+#include "spindle/thread_pool.h"
+
+// Parallel counterparts of standard algorithms, which run on a `ThreadPool` and return once they
+// complete. The calling thread runs parts of the work itself while it waits. Iterators must be
+// random-access. If a callable throws, parts that have not started yet are skipped, and the first
+// exception is rethrown once the running ones complete, in which case the output is unspecified.
+
+namespace spindle {
+
+namespace detail {
+
+// Inputs shorter than this are processed by a single call to the standard algorithm.
+constexpr size_t min_parallel_size = 4096;
+// Merges of fewer elements than this are not split.
+constexpr size_t merge_grain = 8192;
+
+// Returns the number of elements sorted without splitting: small enough that every thread gets
+// several pieces, but large enough that the pieces are worth a task.
+inline size_t sort_grain(ThreadPool& pool, size_t n) {
+    return std::max(n / (8 * size_t{pool.size()}), min_parallel_size);
+}
+
+// The type in which `parallel_inclusive_scan` accumulates the elements at `It` under `BinaryOp`.
+template <class It, class BinaryOp>
+using scan_t = std::decay_t<decltype(std::declval<BinaryOp&>()(*std::declval<It>(),
+                                                                *std::declval<It>()))>;
+
+// Writes the inclusive prefix sums of the `n` elements at `first` under `op` to `d_first`, like
+// `std::partial_sum`, but accumulates them in the type `op` returns rather than in a copy of an
+// element.
+template <class InputIt, class OutputIt, class BinaryOp>
+void inclusive_scan(InputIt first, size_t n, OutputIt d_first, BinaryOp& op) {
+    if (n == 0) return;
+    d_first[0] = first[0];
+    if (n == 1) return;
+    scan_t<InputIt, BinaryOp> acc = op(first[0], first[1]);
+    d_first[1] = acc;
+    for (size_t i = 2; i < n; ++i) {
+        acc = op(std::move(acc), first[i]);
+        d_first[i] = acc;
+    }
+}
+
+// Moves the sorted ranges [`a`, `a_end`) and [`b`, `b_end`) to `out` in order. The larger range is
+// split at its middle element, and the other one where that element would go, so that the lower
+// and upper parts can be merged independently.
+template <class In, class Out, class Compare>
+void merge(ThreadPool& pool, In a, In a_end, In b, In b_end, Out out, Compare& comp) {
+    size_t na = a_end - a;
+    size_t nb = b_end - b;
+    if (na + nb <= merge_grain) {
+        std::merge(std::make_move_iterator(a), std::make_move_iterator(a_end),
+                   std::make_move_iterator(b), std::make_move_iterator(b_end), out, comp);
+        return;
+    }
+    if (na < nb) {
+        std::swap(a, b);
+        std::swap(a_end, b_end);
+        std::swap(na, nb);
+    }
+
+    In a_mid = a + na / 2;
+    In b_mid = std::lower_bound(b, b_end, *a_mid, comp);
+    Out out_mid = out + (a_mid - a) + (b_mid - b);
+    TaskGroup group{pool};
+    group.run([&] { merge(pool, a_mid, a_end, b_mid, b_end, out_mid, comp); });
+    group.run_and_wait([&] { merge(pool, a, a_mid, b, b_mid, out, comp); });
+}
+
+// Sorts the `n` elements at `x`, using the `n` elements at `y` as scratch space, and leaves the
+// result at `y` if `to_y` is set, or at `x` otherwise. The halves are sorted in parallel into the
+// other array, and then merged back.
+template <class X, class Y, class Compare>
+void merge_sort(ThreadPool& pool, X x, Y y, size_t n, bool to_y, size_t grain, Compare& comp) {
+    if (n <= grain) {
+        std::sort(x, x + n, comp);
+        if (to_y) std::move(x, x + n, y);
+        return;
+    }
+
+    size_t m = n / 2;
+    {
+        TaskGroup group{pool};
+        group.run([&] { merge_sort(pool, x + m, y + m, n - m, !to_y, grain, comp); });
+        group.run_and_wait([&] { merge_sort(pool, x, y, m, !to_y, grain, comp); });
+    }
+    if (to_y) {
+        merge(pool, x, x + m, x + m, x + n, y, comp);
+    } else {
+        merge(pool, y, y + m, y + m, y + n, x, comp);
+    }
+}
+
+} // namespace detail
+
+// Sorts [`first`, `last`) with `comp` on `pool`. Like `std::sort`, the sort is not stable. The
+// range is split in halves that are sorted in parallel and then merged by a parallel merge, which
+// takes a buffer as large as the range.
+template <class RandomIt, class Compare = std::less<>>
+void parallel_sort(ThreadPool& pool, RandomIt first, RandomIt last, Compare comp = {}) {
+    size_t n = last - first;
+    if (n <= detail::min_parallel_size) {
+        std::sort(first, last, comp);
+        return;
+    }
+
+    // The elements are sorted in the buffer, and the result is moved back into the range.
+    using T = typename std::iterator_traits<RandomIt>::value_type;
+    std::vector<T> buffer(std::make_move_iterator(first), std::make_move_iterator(last));
+    detail::merge_sort(pool, buffer.begin(), first, n, true, detail::sort_grain(pool, n), comp);
+}
+
+// Writes `op(*it)` for every `it` in [`first`, `last`) to the range that starts at `d_first`, on
+// `pool`, and returns the end of the output. `op` may be called in any order.
+template <class InputIt, class OutputIt, class UnaryOp>
+OutputIt parallel_transform(
+    ThreadPool& pool, InputIt first, InputIt last, OutputIt d_first, UnaryOp op) {
+    size_t n = last - first;
+    if (n <= detail::min_parallel_size) return std::transform(first, last, d_first, op);
+    auto leaf = [&](size_t b, size_t e) { std::transform(first + b, first + e, d_first + b, op); };
+    detail::run_loop(pool, size_t{0}, n, leaf);
+    return d_first + n;
+}
+
+// Writes `op(*it1, *it2)` for every `it1` in [`first1`, `last1`) and the corresponding `it2` in the
+// range that starts at `first2` to the range that starts at `d_first`, on `pool`, like the overload
+// above.
+template <class InputIt1, class InputIt2, class OutputIt, class BinaryOp>
+OutputIt parallel_transform(ThreadPool& pool,
+                            InputIt1 first1,
+                            InputIt1 last1,
+                            InputIt2 first2,
+                            OutputIt d_first,
+                            BinaryOp op) {
+    size_t n = last1 - first1;
+    if (n <= detail::min_parallel_size) return std::transform(first1, last1, first2, d_first, op);
+    auto leaf = [&](size_t b, size_t e) {
+        std::transform(first1 + b, first1 + e, first2 + b, d_first + b, op);
+    };
+    detail::run_loop(pool, size_t{0}, n, leaf);
+    return d_first + n;
+}
+
+// Writes the inclusive prefix sums of [`first`, `last`) under `op` to the range that starts at
+// `d_first`, which may be `first`, on `pool`, and returns the end of the output. `op` must be
+// associative. The range is cut into a few blocks per thread: the blocks are summed in parallel,
+// the sums are scanned to give the carry into each block, and the blocks are then scanned in
+// parallel from their carry, so each element is read twice. The sums are accumulated in the type
+// that `op` returns, and elements of the input are only passed to `op`, except for the first one,
+// which is assigned to the output.
+template <class InputIt, class OutputIt, class BinaryOp = std::plus<>>
+OutputIt parallel_inclusive_scan(
+    ThreadPool& pool, InputIt first, InputIt last, OutputIt d_first, BinaryOp op = {}) {
+    size_t n = last - first;
+    size_t num_blocks = std::min(n / detail::min_parallel_size, 4 * size_t{pool.size()});
+    if (num_blocks <= 1) {
+        detail::inclusive_scan(first, n, d_first, op);
+        return d_first + n;
+    }
+
+    auto block_begin = [&](size_t i) { return n / num_blocks * i + std::min(i, n % num_blocks); };
+    using T = detail::scan_t<InputIt, BinaryOp>;
+    // The sum of each block but the last, and then the sum of all blocks up to each one. Each sum
+    // starts from the first two elements of its block, which holds at least `min_parallel_size`.
+    std::vector<T> sums;
+    sums.reserve(num_blocks - 1);
+    for (size_t i = 0; i + 1 < num_blocks; ++i) {
+        InputIt b = first + block_begin(i);
+        sums.push_back(op(b[0], b[1]));
+    }
+    parallel_for(pool, size_t{0}, num_blocks - 1, [&](size_t i) {
+        InputIt b = first + block_begin(i) + 2;
+        InputIt e = first + block_begin(i + 1);
+        T acc = std::move(sums[i]);
+        for (; b != e; ++b) {
+            acc = op(std::move(acc), *b);
+        }
+        sums[i] = std::move(acc);
+    });
+    for (size_t i = 1; i < sums.size(); ++i) {
+        sums[i] = op(sums[i - 1], sums[i]);
+    }
+
+    parallel_for(pool, size_t{0}, num_blocks, [&](size_t i) {
+        size_t b = block_begin(i);
+        size_t e = block_begin(i + 1);
+        if (i == 0) {
+            detail::inclusive_scan(first, e, d_first, op);
+            return;
+        }
+        T acc = sums[i - 1];
+        for (; b != e; ++b) {
+            acc = op(std::move(acc), first[b]);
+            d_first[b] = acc;
+        }
+    });
+    return d_first + n;
+}
+
+// Returns the first iterator `it` in [`first`, `last`) for which `pred(*it)` is true, or `last`,
+// searching the range on `pool`. Once a match is found, the parts of the range after it are
+// abandoned, and only the parts before it are still searched. `pred` may be called in any order,
+// and on elements past the first match.
+template <class RandomIt, class Predicate>
+RandomIt parallel_find_if(ThreadPool& pool, RandomIt first, RandomIt last, Predicate pred) {
+    // How many elements are searched between checks for an earlier match.
+    constexpr size_t stride = 1024;
+
+    size_t n = last - first;
+    if (n <= detail::min_parallel_size) return std::find_if(first, last, pred);
+    std::atomic<size_t> found{n};
+    auto leaf = [&](size_t b, size_t e) {
+        while (b < e) {
+            if (found.load(std::memory_order_relaxed) < b) return;
+            size_t end = std::min(e, b + stride);
+            for (; b != end; ++b) {
+                if (!pred(first[b])) continue;
+                size_t current = found.load(std::memory_order_relaxed);
+                while (b < current && !found.compare_exchange_weak(current, b)) {
+                }
+                return;
+            }
+        }
+    };
+    detail::run_loop(pool, size_t{0}, n, leaf);
+    return first + found.load();
+}
+
+} // namespace spindle
+
+#endif // SPINDLE_PARALLEL_ALGORITHM_H_
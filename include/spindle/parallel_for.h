@@ -0,0 +1,127 @@
+#ifndef SPINDLE_PARALLEL_FOR_H_
+#define SPINDLE_PARALLEL_FOR_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "spindle/task_group.h"
+#include "spindle/thread_pool.h"
+
+namespace spindle {
+
+namespace detail {
+
+// Returns the number of times the range of a loop is halved before any piece is stolen. This yields
+// about four pieces per thread, which absorbs moderate imbalance without further splitting.
+inline uint32_t initial_depth(uint32_t num_threads) {
+    uint32_t depth = 2;
+    for (uint32_t n = 1; n < num_threads; n <<= 1) {
+        depth++;
+    }
+    return depth;
+}
+
+// `Loop` runs `leaf` over a range by recursively halving it. Each piece keeps the lower half and
+// schedules the upper half, until its split budget is exhausted. A piece that runs on a thread
+// other than the one that scheduled it was picked up by an idle thread, so it earns an extra split
+// to create more work for its peers. Ranges are thus split finely only when threads run out of
+// work, which keeps scheduling overhead low for balanced loops.
+template <class Index, class Leaf>
+class Loop {
+  public:
+    Loop(ThreadPool& pool, Leaf& leaf)
+        : group(pool), leaf(leaf), root_depth(initial_depth(pool.size())) {}
+
+    void run(Index begin, Index end) {
+        group.run_and_wait([this, begin, end] { run(begin, end, root_depth); });
+    }
+
+  private:
+    TaskGroup group;
+    Leaf& leaf;
+    uint32_t root_depth;
+
+    void run(Index begin, Index end, uint32_t depth) {
+        for (; depth > 0 && end - begin > 1; --depth) {
+            Index mid = begin + (end - begin) / 2;
+            group.run([this, mid, end, depth, spawner = std::this_thread::get_id()] {
+                bool stolen = std::this_thread::get_id() != spawner;
+                run(mid, end, stolen ? depth : depth - 1);
+            });
+            end = mid;
+        }
+        leaf(begin, end);
+    }
+};
+
+template <class Index, class Leaf>
+void run_loop(ThreadPool& pool, Index begin, Index end, Leaf& leaf) {
+    if (!(begin < end)) return;
+    Loop<Index, Leaf>{pool, leaf}.run(begin, end);
+}
+
+} // namespace detail
+
+// Calls `body(i)` for every `i` in [`begin`, `end`) on `pool`, and returns once all calls have
+// completed. `Index` is an integral type or a random-access iterator. The range is split into
+// pieces adaptively, so no grain size needs to be chosen, and the calling thread runs pieces
+// itself while it waits. If a call throws, pieces that have not started yet are skipped, and the
+// first exception is rethrown once the running ones complete.
+template <class Index, class Body>
+void parallel_for(ThreadPool& pool, Index begin, Index end, Body body) {
+    auto leaf = [&body](Index b, Index e) {
+        for (; b != e; ++b) {
+            body(b);
+        }
+    };
+    detail::run_loop(pool, begin, end, leaf);
+}
+
+// Folds [`begin`, `end`) on `pool` with `body(b, e, acc)`, which folds the sub-range [`b`, `e`)
+// into `acc` and returns the result. Each piece of the range starts from `identity`, and the
+// results of the pieces are combined in the order of their sub-ranges with `reduce`, so `reduce`
+// must be associative and `identity` must be its identity element, but `reduce` need not be
+// commutative. Splitting, helping and exceptions work as in `parallel_for`.
+template <class Index, class T, class Body, class Reduce>
+T parallel_reduce(ThreadPool& pool, Index begin, Index end, T identity, Body body, Reduce reduce) {
+    std::mutex m;
+    std::vector<std::pair<Index, T>> partials;
+    auto leaf = [&](Index b, Index e) {
+        T acc = body(b, e, identity);
+        std::lock_guard<std::mutex> lk{m};
+        partials.emplace_back(b, std::move(acc));
+    };
+    detail::run_loop(pool, begin, end, leaf);
+
+    std::sort(partials.begin(), partials.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.first < rhs.first;
+    });
+    T result = std::move(identity);
+    for (auto&& partial : partials) {
+        result = reduce(std::move(result), std::move(partial.second));
+    }
+    return result;
+}
+
+// Returns the result of folding `transform(i)` for every `i` in [`begin`, `end`) with `reduce`,
+// starting from `identity`, like `parallel_reduce`.
+template <class Index, class T, class Reduce, class Transform>
+T parallel_transform_reduce(
+    ThreadPool& pool, Index begin, Index end, T identity, Reduce reduce, Transform transform) {
+    auto body = [&](Index b, Index e, T acc) {
+        for (; b != e; ++b) {
+            acc = reduce(std::move(acc), transform(b));
+        }
+        return acc;
+    };
+    return parallel_reduce(pool, begin, end, std::move(identity), body, reduce);
+}
+
+} // namespace spindle
+
+#endif // SPINDLE_PARALLEL_FOR_H_
@@ -0,0 +1,32 @@
+#ifndef SPINDLE_PRIORITY_H_
+#define SPINDLE_PRIORITY_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace spindle {
+
+// `Priority` is the class of an immediate task, which determines how soon it runs relative to the
+// other tasks queued on the same thread. Higher classes are served more often, but not exclusively:
+// a backlogged thread still takes one background task for every 16 tasks it runs, and three normal
+// ones, so no class starves.
+enum class Priority {
+    critical,
+    normal,
+    background,
+};
+
+constexpr size_t num_priorities = 3;
+
+// `QueueingDelay` summarizes how long the tasks of a priority class waited in a queue before they
+// started running.
+struct QueueingDelay {
+    uint64_t tasks;
+    std::chrono::nanoseconds total;
+    std::chrono::nanoseconds max;
+};
+
+} // namespace spindle
+
+#endif // SPINDLE_PRIORITY_H_
@@ -0,0 +1,41 @@
+#ifndef SPINDLE_SEMAPHORE_H_
+#define SPINDLE_SEMAPHORE_H_
+
+#include <atomic>
+#include <cstdint>
+
+namespace spindle {
+
+// `Semaphore` is a counting semaphore. `acquire` blocks until the count is positive and then
+// decrements it, and `release` increments it. The count is a single atomic word, so neither
+// operation takes a lock, and `release` only enters the kernel if a thread is blocked in
+// `acquire`.
+class Semaphore {
+  public:
+    // The largest count a `Semaphore` can hold.
+    static constexpr uint32_t max_count = (uint32_t{1} << 31) - 1;
+
+    // Creates a `Semaphore` with an initial count of `count`, which must not exceed `max_count`.
+    explicit Semaphore(uint32_t count = 0);
+
+    Semaphore(const Semaphore&) = delete;
+    Semaphore& operator=(const Semaphore&) = delete;
+
+    // Increments the count by `n`. Throws `std::runtime_error` if the count would exceed
+    // `max_count`.
+    void release(uint32_t n = 1);
+    // Blocks until the count is positive, and then decrements it.
+    void acquire();
+    // Decrements the count if it is positive. Returns false otherwise.
+    bool try_acquire();
+
+  private:
+    // Set in `state` once a thread blocks in `acquire`. The remaining bits hold the count.
+    static constexpr uint32_t waiting = uint32_t{1} << 31;
+
+    std::atomic_uint32_t state;
+};
+
+} // namespace spindle
+
+#endif // SPINDLE_SEMAPHORE_H_
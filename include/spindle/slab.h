@@ -0,0 +1,62 @@
+#ifndef SPINDLE_SLAB_H_
+#define SPINDLE_SLAB_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+namespace spindle {
+
+namespace detail {
+
+// The slab allocator hands out small blocks from arenas that belong to a thread each, such as the
+// thread of a `Worker`, so that the steady state of submitting and running tasks never calls into
+// the global allocator. Each arena keeps a free list per size class, which its thread pops and
+// pushes without synchronization, and carves new blocks out of large chunks once a list runs dry.
+// A block that is freed on another thread is pushed to a lock-free list of its arena instead, which
+// the owning thread takes over in one go when its own list runs dry. Arenas are never released:
+// the arena of a thread that exits is handed over to the next thread that starts.
+
+// Largest block the slab allocator serves. Larger blocks come from the global allocator.
+constexpr size_t max_slab_size = 2048 - 16;
+
+// Returns a block of at least `size` bytes, aligned for any scalar type.
+void* slab_allocate(size_t size);
+// Returns a block obtained from `slab_allocate` to its arena, from any thread.
+void slab_deallocate(void* p) noexcept;
+
+// `SlabAllocator` is an allocator for standard containers and `std::allocate_shared` that draws
+// from the slab allocator.
+template <class T>
+class SlabAllocator {
+  public:
+    using value_type = T;
+
+    SlabAllocator() noexcept = default;
+    template <class U>
+    SlabAllocator(const SlabAllocator<U>&) noexcept {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(slab_allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t) noexcept {
+        slab_deallocate(p);
+    }
+
+    template <class U>
+    bool operator==(const SlabAllocator<U>&) const noexcept {
+        return true;
+    }
+
+    template <class U>
+    bool operator!=(const SlabAllocator<U>&) const noexcept {
+        return false;
+    }
+};
+
+} // namespace detail
+
+} // namespace spindle
+
+#endif // SPINDLE_SLAB_H_
@@ -0,0 +1,41 @@
+#ifndef SPINDLE_STRAND_H_
+#define SPINDLE_STRAND_H_
+
+#include <memory>
+
+#include "spindle/task.h"
+#include "spindle/thread_pool.h"
+
+namespace spindle {
+
+// `Strand` runs tasks on a `ThreadPool` one at a time, in the order they were queued, without
+// dedicating a thread to them. Tasks queue on the strand itself rather than on the pool, and the
+// strand is scheduled on the pool as a single task whenever it has work, which then runs a batch of
+// the queued tasks on whichever thread picks it up. Queuing a task takes no lock, so many strands
+// can share a few threads. Copies of a `Strand` refer to the same queue, which outlives them until
+// the queued tasks have run.
+class Strand {
+  public:
+    // At most this many tasks run back to back before the strand is queued on the pool again, which
+    // lets the other tasks of the pool run.
+    static constexpr size_t batch_size = 64;
+
+    explicit Strand(ThreadPool& pool);
+
+    // Queues `task` on the strand. It runs after the tasks queued before it have completed, and
+    // never concurrently with another task of the strand. The queued tasks are dropped if the pool
+    // rejects or drops the strand, and the next task queued schedules it again. If a task throws,
+    // the exception propagates to the thread that ran the strand, and the other tasks run later.
+    void execute(Task task);
+    // Returns true if the calling thread is running a task of this strand.
+    bool running_in_this_thread() const;
+
+  private:
+    class Queue;
+
+    std::shared_ptr<Queue> queue;
+};
+
+} // namespace spindle
+
+#endif // SPINDLE_STRAND_H_
@@ -0,0 +1,183 @@
+#ifndef SPINDLE_TASK_H_
+#define SPINDLE_TASK_H_
+
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "spindle/slab.h"
+
+namespace spindle {
+
+// `Task` is a move-only, type-erased callable that takes no arguments and returns nothing. Unlike
+// `std::function`, it accepts callables that cannot be copied, such as closures that capture a
+// `std::unique_ptr`. Callables of up to `Task::inline_size` bytes that can be moved without
+// throwing are stored inline, so constructing, moving and invoking such a `Task` never allocates.
+// Larger callables are moved to a block of the slab allocator of the constructing thread, which
+// only calls into the global allocator while its free lists grow. A moved-from `Task` is empty.
+class Task {
+  public:
+    static constexpr size_t inline_size = 48;
+
+    // Creates an empty `Task`.
+    Task() noexcept = default;
+    Task(std::nullptr_t) noexcept {}
+
+    template <class F,
+              class D = typename std::decay<F>::type,
+              class = typename std::enable_if<!std::is_same<D, Task>::value>::type,
+              class = decltype(std::declval<D&>()())>
+    Task(F&& f) {
+        init<D>(std::forward<F>(f), std::integral_constant<bool, fits_inline<D>>{});
+    }
+
+    Task(Task&& other) noexcept {
+        take(other);
+    }
+
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            reset();
+            take(other);
+        }
+        return *this;
+    }
+
+    Task& operator=(std::nullptr_t) noexcept {
+        reset();
+        return *this;
+    }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    ~Task() {
+        reset();
+    }
+
+    // Invokes the stored callable. Throws `std::bad_function_call` if the `Task` is empty.
+    void operator()() {
+        if (vtable == nullptr) throw std::bad_function_call{};
+        vtable->invoke(&storage);
+    }
+
+    explicit operator bool() const noexcept {
+        return vtable != nullptr;
+    }
+
+  private:
+    struct VTable {
+        void (*invoke)(void* storage);
+        // Move-constructs the callable in `src` into `dst` and destroys the one in `src`. A null
+        // pointer means the storage can be copied bytewise.
+        void (*relocate)(void* dst, void* src);
+        // A null pointer means there is nothing to destroy.
+        void (*destroy)(void* storage);
+    };
+
+    template <class D>
+    static constexpr bool fits_inline = sizeof(D) <= inline_size &&
+                                        alignof(D) <= alignof(std::max_align_t) &&
+                                        std::is_nothrow_move_constructible<D>::value;
+
+    template <class D>
+    struct Inline {
+        static constexpr bool trivial =
+            std::is_trivially_copyable<D>::value && std::is_trivially_destructible<D>::value;
+
+        static void invoke(void* storage) {
+            (*static_cast<D*>(storage))();
+        }
+
+        static void relocate(void* dst, void* src) {
+            D* f = static_cast<D*>(src);
+            ::new (dst) D(std::move(*f));
+            f->~D();
+        }
+
+        static void destroy(void* storage) {
+            static_cast<D*>(storage)->~D();
+        }
+
+        static constexpr VTable vtable{
+            invoke, trivial ? nullptr : relocate, trivial ? nullptr : destroy};
+    };
+
+    template <class D>
+    struct Heap {
+        // Over-aligned callables do not fit the blocks of the slab allocator.
+        static constexpr bool slab = alignof(D) <= alignof(std::max_align_t);
+
+        template <class F>
+        static D* create(F&& f) {
+            if (!slab) return new D(std::forward<F>(f));
+            void* block = detail::slab_allocate(sizeof(D));
+            try {
+                return ::new (block) D(std::forward<F>(f));
+            } catch (...) {
+                detail::slab_deallocate(block);
+                throw;
+            }
+        }
+
+        static void invoke(void* storage) {
+            (**static_cast<D**>(storage))();
+        }
+
+        static void destroy(void* storage) {
+            D* f = *static_cast<D**>(storage);
+            if (!slab) {
+                delete f;
+                return;
+            }
+            f->~D();
+            detail::slab_deallocate(f);
+        }
+
+        static constexpr VTable vtable{invoke, nullptr, destroy};
+    };
+
+    alignas(std::max_align_t) unsigned char storage[inline_size];
+    const VTable* vtable{};
+
+    template <class D, class F>
+    void init(F&& f, std::true_type) {
+        ::new (&storage) D(std::forward<F>(f));
+        vtable = &Inline<D>::vtable;
+    }
+
+    template <class D, class F>
+    void init(F&& f, std::false_type) {
+        ::new (&storage) D*(Heap<D>::create(std::forward<F>(f)));
+        vtable = &Heap<D>::vtable;
+    }
+
+    void take(Task& other) noexcept {
+        vtable = other.vtable;
+        if (vtable == nullptr) return;
+        if (vtable->relocate != nullptr) {
+            vtable->relocate(&storage, &other.storage);
+        } else {
+            std::memcpy(&storage, &other.storage, inline_size);
+        }
+        other.vtable = nullptr;
+    }
+
+    void reset() noexcept {
+        if (vtable != nullptr && vtable->destroy != nullptr) vtable->destroy(&storage);
+        vtable = nullptr;
+    }
+};
+
+template <class D>
+constexpr Task::VTable Task::Inline<D>::vtable;
+
+template <class D>
+constexpr Task::VTable Task::Heap<D>::vtable;
+
+} // namespace spindle
+
+#endif // SPINDLE_TASK_H_
@@ -0,0 +1,69 @@
+#ifndef SPINDLE_TASK_GRAPH_H_
+#define SPINDLE_TASK_GRAPH_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <vector>
+
+#include "spindle/task.h"
+#include "spindle/task_group.h"
+#include "spindle/thread_pool.h"
+
+namespace spindle {
+
+// `TaskGraph` is a directed acyclic graph of tasks, in which each task runs once all of its
+// predecessors have completed. Every node keeps an atomic count of the predecessors that have yet
+// to complete in the current run. The thread that completes the last predecessor of a node runs
+// the node right away, and schedules any other nodes that became ready on the `ThreadPool`, so no
+// thread ever blocks on a dependency. A graph is built once and can be run any number of times;
+// runs do not allocate unless the graph has changed since the previous run.
+class TaskGraph {
+  public:
+    using NodeId = size_t;
+
+    TaskGraph() = default;
+
+    TaskGraph(const TaskGraph&) = delete;
+    TaskGraph& operator=(const TaskGraph&) = delete;
+
+    // Adds a node that runs `task` after the nodes in `predecessors` have completed, and returns
+    // its identifier. `task` is invoked once per run, and may be empty to only join its
+    // predecessors.
+    NodeId add(Task task, std::initializer_list<NodeId> predecessors = {});
+    // Makes `node` run after `predecessor` has completed.
+    void add_dependency(NodeId node, NodeId predecessor);
+
+    // Runs every node of the graph on `pool`, and returns once all of them have completed. The
+    // calling thread runs queued tasks while it waits. If a task throws, nodes that have not
+    // started yet are skipped, and the first exception is rethrown once the running ones complete.
+    // Throws `std::runtime_error` if the graph has a cycle. A graph must not be run concurrently
+    // with itself or modified while it runs.
+    void run(ThreadPool& pool);
+
+    size_t size() const;
+
+  private:
+    struct Node {
+        Task task;
+        std::vector<NodeId> successors;
+        uint32_t num_predecessors;
+        std::atomic_uint32_t remaining;
+    };
+
+    std::vector<std::unique_ptr<Node>> nodes;
+    // Nodes without predecessors, which is only up to date if `validated` is set.
+    std::vector<NodeId> roots;
+    bool validated{true};
+
+    void check(NodeId node) const;
+    void validate();
+    void schedule(TaskGroup& group, NodeId node);
+    void run_node(TaskGroup& group, NodeId node);
+};
+
+} // namespace spindle
+
+#endif // SPINDLE_TASK_GRAPH_H_
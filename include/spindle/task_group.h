@@ -0,0 +1,120 @@
+#ifndef SPINDLE_TASK_GROUP_H_
+#define SPINDLE_TASK_GROUP_H_
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <future>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+
+#include "spindle/thread_pool.h"
+
+namespace spindle {
+
+// `TaskGroup` runs a set of tasks on a `ThreadPool` and waits for all of them to complete. Unlike
+// waiting on a `Latch`, a thread that waits on a `TaskGroup` runs queued tasks of the pool until
+// the group completes, so tasks can fork and join nested groups without tying up pool threads.
+// Waiting blocks only once there is nothing left to run, which means the remaining tasks of the
+// group are running on other threads. A group can be reused once `wait` returns.
+class TaskGroup {
+  public:
+    explicit TaskGroup(ThreadPool& pool);
+    // Waits for the tasks of the group, discarding any exception they throw.
+    ~TaskGroup();
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    // Schedules `f` on the pool as part of this group. If `f` is rejected by the pool, `wait`
+    // throws a `std::future_error` with the `broken_promise` code.
+    template <class F>
+    void run(F&& f);
+    // Runs `f` on the calling thread as part of this group, and then waits like `wait`.
+    template <class F>
+    void run_and_wait(F&& f);
+    // Blocks until every task of the group has completed, running queued tasks of the pool in the
+    // meantime. Rethrows the first exception thrown by a task of the group, if any.
+    void wait();
+
+    // Skips the tasks of the group that have not started yet. A task that throws cancels its group.
+    // The group is no longer cancelled once `wait` returns.
+    void cancel();
+    bool is_cancelled() const;
+
+  private:
+    // `Member` wraps a task of the group. A `Member` that is destroyed without running completes
+    // the task with an error, so that the group does not wait for it forever.
+    template <class F>
+    class Member {
+      public:
+        Member(TaskGroup* group, F f) : group(group), f(std::move(f)) {}
+
+        Member(Member&& other) noexcept(std::is_nothrow_move_constructible<F>::value)
+            : group(other.group), f(std::move(other.f)) {
+            other.group = nullptr;
+        }
+
+        Member& operator=(Member&&) = delete;
+
+        ~Member() {
+            if (group == nullptr) return;
+            group->fail(
+                std::make_exception_ptr(std::future_error{std::future_errc::broken_promise}));
+            group->complete();
+        }
+
+        void operator()() {
+            TaskGroup* g = group;
+            group = nullptr;
+            g->invoke(f);
+        }
+
+      private:
+        TaskGroup* group;
+        F f;
+    };
+
+    ThreadPool& pool;
+    std::atomic_size_t pending{};
+    std::atomic_bool cancelled{};
+    // Guards `error`, and makes completing the last task and observing it atomic, so that the group
+    // can be destroyed as soon as `wait` returns.
+    std::mutex m;
+    std::exception_ptr error;
+
+    template <class F>
+    void invoke(F& f);
+    void complete();
+    void fail(std::exception_ptr e);
+};
+
+template <class F>
+void TaskGroup::run(F&& f) {
+    pending.fetch_add(1, std::memory_order_relaxed);
+    pool.execute(Member<typename std::decay<F>::type>{this, std::forward<F>(f)});
+}
+
+template <class F>
+void TaskGroup::run_and_wait(F&& f) {
+    pending.fetch_add(1, std::memory_order_relaxed);
+    invoke(f);
+    wait();
+}
+
+template <class F>
+void TaskGroup::invoke(F& f) {
+    if (!is_cancelled()) {
+        try {
+            f();
+        } catch (...) {
+            fail(std::current_exception());
+        }
+    }
+    complete();
+}
+
+} // namespace spindle
+
+#endif // SPINDLE_TASK_GROUP_H_
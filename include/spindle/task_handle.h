@@ -0,0 +1,100 @@
+#ifndef SPINDLE_TASK_HANDLE_H_
+#define SPINDLE_TASK_HANDLE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "spindle/slab.h"
+#include "spindle/task.h"
+
+namespace spindle {
+
+namespace detail {
+
+// `CancelState` is shared by a cancellable task and its `TaskHandle`. Cancelling a task only marks
+// it, and whoever holds the task discards it when it comes up instead of running it.
+class CancelState {
+  public:
+    // `tombstones`, if not null, counts the cancelled tasks that are still held by their owner.
+    explicit CancelState(std::shared_ptr<std::atomic<int64_t>> tombstones = nullptr)
+        : tombstones(std::move(tombstones)) {}
+
+    // Marks a task that runs once as started. Returns false if it was cancelled, in which case it
+    // must not run.
+    bool start() {
+        uint8_t expected = pending;
+        return status.compare_exchange_strong(expected, started, std::memory_order_acq_rel);
+    }
+
+    // Returns false if the task already started or was already cancelled.
+    bool cancel() {
+        uint8_t expected = pending;
+        if (!status.compare_exchange_strong(expected, cancelled_, std::memory_order_acq_rel)) {
+            return false;
+        }
+        if (tombstones) tombstones->fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    bool cancelled() const {
+        return status.load(std::memory_order_acquire) == cancelled_;
+    }
+
+  private:
+    enum : uint8_t { pending, started, cancelled_ };
+
+    std::atomic<uint8_t> status{pending};
+    std::shared_ptr<std::atomic<int64_t>> tombstones;
+};
+
+// Creates the state of a cancellable task, which comes from the slab allocator of the calling
+// thread.
+inline std::shared_ptr<CancelState> make_cancel_state(
+    std::shared_ptr<std::atomic<int64_t>> tombstones = nullptr) {
+    return std::allocate_shared<CancelState>(SlabAllocator<CancelState>{}, std::move(tombstones));
+}
+
+// Wraps `task` so that it only runs if `state` was not cancelled before it started.
+inline Task cancellable(Task task, std::shared_ptr<CancelState> state) {
+    return [task = std::move(task), state = std::move(state)]() mutable {
+        if (state->start()) task();
+    };
+}
+
+} // namespace detail
+
+// `TaskHandle` refers to a scheduled task, and cancels it as long as it has not started. A task
+// that is cancelled never runs, and a periodic task that is cancelled does not run again, although
+// a run that is in progress completes. Cancelling takes constant time, as the task is only marked
+// and then discarded by the thread that holds it once it comes up. A handle does not keep its task
+// alive, and copies of a handle refer to the same task.
+class TaskHandle {
+  public:
+    // Creates a handle that refers to no task.
+    TaskHandle() = default;
+    explicit TaskHandle(std::shared_ptr<detail::CancelState> state) : state(std::move(state)) {}
+
+    // Cancels the task. Returns true if this call prevented the task from running, or from running
+    // again if it is periodic, and false if the task already started or was already cancelled.
+    bool cancel() {
+        return state != nullptr && state->cancel();
+    }
+
+    bool cancelled() const {
+        return state != nullptr && state->cancelled();
+    }
+
+    // Returns true if the handle refers to a task, which is not the case if the task was rejected.
+    explicit operator bool() const noexcept {
+        return state != nullptr;
+    }
+
+  private:
+    std::shared_ptr<detail::CancelState> state;
+};
+
+} // namespace spindle
+
+#endif // SPINDLE_TASK_HANDLE_H_
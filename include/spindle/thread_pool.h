@@ -2,44 +2,246 @@
 #define SPINDLE_THREAD_POOL_H_
 
 #include <atomic>
-#include <functional>
+#include <chrono>
+#include <iosfwd>
+#include <iterator>
+#include <memory>
+#include <mutex>
 #include <thread>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#include "spindle/future.h"
+#include "spindle/metrics.h"
+#include "spindle/missed_run_policy.h"
+#include "spindle/priority.h"
+#include "spindle/task.h"
+#include "spindle/task_handle.h"
+#include "spindle/thread_pool_options.h"
+
 namespace spindle {
 
+class EventCount;
+class Scheduler;
+class Thread;
 class Worker;
 
 // `ThreadPool` is a collection of threads on which work can be scheduled for execution. The threads
-// correspond to operating system threads and are therefore subject to its scheduling policy.
+// correspond to operating system threads and are therefore subject to its scheduling policy. Each
+// thread owns a queue of tasks, and a thread that runs out of work steals tasks queued on others.
+// Threads can be pinned to CPUs and grouped by NUMA node, in which case tasks submitted from
+// outside the pool are queued on a thread of the submitter's node, and threads steal from the
+// threads of their own node before the others. A pool can also be elastic, starting threads as
+// tasks queue up and reaping them once they are idle; see `ThreadPoolOptions::min_threads`.
 class ThreadPool {
   public:
     // Creates a thread pool with a number of threads equal to the system's hardware concurrency.
     ThreadPool();
     // Creates a thread pool with the specified number of threads.
     ThreadPool(uint32_t num_threads);
+    // Creates a thread pool configured by `options`.
+    explicit ThreadPool(const ThreadPoolOptions& options);
+
+    // Returns a process-wide, elastic thread pool, which is created on first use. It starts without
+    // any threads, and grows up to the system's hardware concurrency as tasks queue up.
+    static ThreadPool& default_pool();
 
     // Terminates all worker threads. Any inflight tasks continue to execute but no new tasks
     // will be enqueued or executed.
     ~ThreadPool();
 
-    // Schedules a task for execution on one of the threads in this `ThreadPool`. Calling this
-    // method concurrently with `ThreadPool::tear_down` does not guarantee execution of the task.
-    void execute(const std::function<void()>& task);
+    // Schedules a task of the given priority for execution on one of the threads in this
+    // `ThreadPool`. Tasks scheduled from within a task are queued on the calling thread. If the
+    // queue of the thread is bounded and full, the task is dealt with according to
+    // `ThreadPoolOptions::overflow_policy`. Calling this method concurrently with
+    // `ThreadPool::tear_down` does not guarantee execution of the task.
+    void execute(Task task, Priority priority = Priority::normal);
+    // Schedules a task like `execute`, unless the queue of the thread it would go to is full. See
+    // `ThreadPoolOptions::queue_capacity`. Returns false, leaving `task` untouched, if the task
+    // was not queued because the queue is full or the pool no longer accepts tasks.
+    bool try_execute(Task&& task, Priority priority = Priority::normal);
+    // Schedules a task like `execute`, and returns a handle that cancels it until it starts. Unlike
+    // `execute`, this allocates the state the task shares with its handle.
+    TaskHandle execute_cancellable(Task task, Priority priority = Priority::normal);
+    // Schedules a task for execution on one of the threads in this `ThreadPool` once `delay` has
+    // elapsed. Tasks scheduled from within a task are queued on the calling thread. Returns a
+    // handle that cancels the task until it starts, which refers to no task if it was rejected.
+    TaskHandle execute_after(Task task, std::chrono::nanoseconds delay);
+    // Schedules a task for execution on the thread at `worker_index`, in [0, `size()`). Unlike
+    // other tasks, the task is never stolen by another thread. Throws `std::runtime_error` if the
+    // index is out of range.
+    void execute_on(uint32_t worker_index, Task task);
+
+    // Schedules a task for execution once `delay` has elapsed. Unlike `execute_after`, which keeps
+    // the task on one thread until it is due, the task waits on a timer thread of the pool, which
+    // starts on first use, and is then queued on the least loaded thread, so its precision does
+    // not depend on how busy any one thread is. Returns a handle that cancels the task until it is
+    // due, which refers to no task if the pool is draining or terminated.
+    TaskHandle schedule_after(Task task, std::chrono::nanoseconds delay);
+    // Schedules a task on the timer thread like `schedule_after`, which runs once `initial_delay`
+    // has elapsed and then every `period`. Runs never overlap, so a run that is due while the
+    // previous one is still in progress is missed, and made up for or skipped as `policy` says.
+    // Returns a handle that stops the task from running again. Throws `std::runtime_error` if
+    // `period` is not positive.
+    TaskHandle schedule_at_fixed_rate(Task task,
+                                      std::chrono::nanoseconds initial_delay,
+                                      std::chrono::nanoseconds period,
+                                      MissedRunPolicy policy = MissedRunPolicy::catch_up);
+    // Schedules a task on the timer thread like `schedule_after`, which runs once `initial_delay`
+    // has elapsed and then `delay` after each run completes. Returns a handle that stops the task
+    // from running again. Throws `std::runtime_error` if `delay` is not positive.
+    TaskHandle schedule_with_fixed_delay(Task task,
+                                         std::chrono::nanoseconds initial_delay,
+                                         std::chrono::nanoseconds delay);
+
+    // Schedules the tasks in [`first`, `last`) for execution, moving from them. The batch is split
+    // into contiguous blocks, one per thread, and each thread is woken at most once, so this is
+    // considerably cheaper than calling `execute` for each task.
+    void execute_bulk(Task* first, Task* last);
+    // Schedules the callables in [`first`, `last`) for execution like the overload above, after
+    // converting them to a contiguous batch of `Task`s.
+    template <class It>
+    void execute_bulk(It first, It last);
+
+    // Schedules `f` for execution like `execute`, and returns a `Future` for its result or for the
+    // exception it throws. Continuations attached to the `Future` run on this `ThreadPool`. If the
+    // task is rejected, the `Future` holds a `std::future_error` with the `broken_promise` code.
+    template <class F, class R = decltype(std::declval<std::decay_t<F>&>()())>
+    Future<R> submit(F&& f);
+
+    // Runs one queued immediate task on the calling thread, taking it from the calling worker's
+    // queue first if the caller belongs to this `ThreadPool`, and from any other thread's queue
+    // otherwise. Returns false if no task was queued. Threads that wait on work they scheduled can
+    // call this method to help instead of blocking.
+    bool try_run_one();
+
+    // Returns the maximum number of threads in this `ThreadPool`.
+    uint32_t size() const;
+    // Returns the number of threads that are currently running, which only differs from `size` if
+    // the pool is elastic.
+    uint32_t num_threads() const;
+    // Returns how long the immediate tasks of the given priority that have started so far waited in
+    // a queue, over all threads.
+    QueueingDelay queueing_delay(Priority priority) const;
+    // Returns a snapshot of the activity of each thread, such as its queue depth, how many tasks it
+    // ran and stole, how long it was busy and idle, and how long its tasks waited in its queues.
+    Metrics metrics() const;
+    // Writes the tasks recorded by each thread as a trace in the Chrome trace event format, which
+    // Perfetto opens. See `ThreadPoolOptions::trace_capacity`. The trace is empty unless the
+    // library is built with `SPINDLE_TRACING`.
+    void write_trace(std::ostream& out) const;
+
+    // `ScheduleOperation` resumes a coroutine that awaits it on a thread of `pool`. If the queue
+    // is full or the pool no longer accepts tasks, the coroutine continues on the awaiting thread
+    // instead. Awaiting it requires `spindle/coro.h`, which is part of the C++20 build.
+    struct ScheduleOperation {
+        ThreadPool* pool;
+    };
+    // `SleepOperation` resumes a coroutine that awaits it on a thread of `pool` once `delay` has
+    // elapsed, without blocking any thread in the meantime. If the pool no longer accepts tasks,
+    // the awaiting thread sleeps and the coroutine continues on it. Awaiting it requires
+    // `spindle/coro.h`.
+    struct SleepOperation {
+        ThreadPool* pool;
+        std::chrono::nanoseconds delay;
+    };
+
+    // Returns an operation that moves the awaiting coroutine onto this `ThreadPool`.
+    ScheduleOperation schedule();
+    // Returns an operation that suspends the awaiting coroutine for `delay`, and then resumes it on
+    // this `ThreadPool`.
+    SleepOperation sleep_for(std::chrono::nanoseconds delay);
 
     // Puts the `ThreadPool` in a state that prevents scheduling further tasks, and then blocks
-    // until all inflight and queued tasks are executed.
+    // until all inflight and queued tasks are executed. Tasks that wait on the timer thread are
+    // executed once they are due, except for periodic ones, which stop.
     void drain();
 
     // Identical to the destructor.
     void tear_down();
 
   private:
+    // The options the pool was created with, where `cpu_affinity` holds the CPUs of every thread.
+    ThreadPoolOptions options;
     std::vector<std::unique_ptr<Worker>> workers;
-    std::vector<std::thread> worker_threads;
+    // A thread per worker, which is null until the worker first starts. The workers with a running
+    // thread are always the first `num_running` ones.
+    std::vector<std::unique_ptr<Thread>> worker_threads;
     std::atomic_int next_worker;
+    uint32_t min_threads;
+    std::atomic_uint32_t num_running;
+    // Guards starting and retiring threads.
+    std::mutex threads_m;
+    // Set once the pool is draining or terminated, after which threads neither start nor retire.
+    bool stopping{false};
+    // The indices of the workers on each NUMA node that has any, and the index in `node_workers` of
+    // the node of each CPU, or -1. Both are empty unless the workers span several nodes.
+    std::vector<std::vector<uint32_t>> node_workers;
+    std::vector<int> cpu_nodes;
+    // Holds the tasks that wait on the timer thread. Null until first used, and guarded by
+    // `threads_m`.
+    std::unique_ptr<Scheduler> scheduler;
+    // Threads that wait for a `TaskGroup` block on `helpers` once there is nothing for them to run.
+    // Workers notify it whenever they queue a task that can be stolen, and groups whenever their
+    // last task completes.
+    std::unique_ptr<EventCount> helpers;
+
+    friend class TaskGroup;
+
+    // Picks the worker on which to queue a task submitted from outside the pool.
+    uint32_t next_external_worker();
+    // Picks one of the first `n` workers, or of the first `n` in `candidates` if it is not null,
+    // according to the dispatch policy.
+    uint32_t pick(uint32_t n, const std::vector<uint32_t>* candidates = nullptr);
+    // Returns the number of running workers, starting one if there is none.
+    uint32_t running_workers();
+    // Starts a thread for the worker at `idx`. Must be called with `threads_m` held.
+    void start(uint32_t idx);
+    // Starts one more thread, if the pool is not at its maximum size.
+    void grow();
+    // Starts threads until the first `n` workers are running.
+    void grow_to(uint32_t n);
+    // Same as `grow_to`, but must be called with `threads_m` held.
+    void start_prefix(uint32_t n);
+    // Starts the worker at `idx` if its thread has retired, so that the tasks just queued on it
+    // run.
+    void ensure_running(uint32_t idx);
+    // Returns the scheduler, starting it on first use, or null if the pool is stopping before it
+    // was ever used.
+    Scheduler* timer_thread();
+    // Queues a task that is due on the least loaded running worker.
+    void dispatch(Task task);
+    // Decides whether the idle worker at `idx` may retire its thread.
+    bool retire(uint32_t idx);
+    void join();
+    // Fills in the CPUs of threads that are not pinned if `numa_aware` is set, records the node of
+    // each thread in `thread_nodes`, and sets up `node_workers` and `cpu_nodes`.
+    void place(bool numa_aware,
+               std::vector<std::vector<uint32_t>>& thread_cpus,
+               std::vector<int>& thread_nodes);
 };
 
+template <class It>
+void ThreadPool::execute_bulk(It first, It last) {
+    std::vector<Task> tasks;
+    tasks.reserve(std::distance(first, last));
+    for (; first != last; ++first) {
+        tasks.emplace_back(std::move(*first));
+    }
+    execute_bulk(tasks.data(), tasks.data() + tasks.size());
+}
+
+template <class F, class R>
+Future<R> ThreadPool::submit(F&& f) {
+    Promise<R> promise{this};
+    Future<R> future = promise.get_future();
+    execute([promise = std::move(promise), f = std::forward<F>(f)]() mutable {
+        detail::fulfil(promise, f);
+    });
+    return future;
+}
+
 } // namespace spindle
 
 #endif // SPINDLE_THREAD_POOL_H_
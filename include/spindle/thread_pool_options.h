@@ -0,0 +1,59 @@
+#ifndef SPINDLE_THREAD_POOL_OPTIONS_H_
+#define SPINDLE_THREAD_POOL_OPTIONS_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "spindle/dispatch_policy.h"
+#include "spindle/overflow_policy.h"
+#include "spindle/wait_strategy.h"
+
+namespace spindle {
+
+// `ThreadPoolOptions` configures the threads of a `ThreadPool` and where they run.
+struct ThreadPoolOptions {
+    // Maximum number of threads, which must be positive.
+    uint32_t num_threads{std::thread::hardware_concurrency()};
+    // Number of threads that start along with the pool and are never reaped, which is capped at
+    // `num_threads`. The pool is elastic if this is lower than `num_threads`: another thread is
+    // started whenever a task is queued while every running thread is busy, and the most recently
+    // started thread is reaped once it has been idle for `idle_timeout`.
+    uint32_t min_threads{std::numeric_limits<uint32_t>::max()};
+    std::chrono::nanoseconds idle_timeout{std::chrono::seconds{10}};
+    // How tasks submitted from outside the pool are spread across its threads. Tasks submitted from
+    // within the pool stay on the submitting thread regardless.
+    DispatchPolicy dispatch_policy{DispatchPolicy::round_robin};
+    // Maximum number of immediate tasks of each `Priority` queued on each thread, which is rounded
+    // up to a power of two, or zero for no limit. Tasks for a specific thread, which are submitted
+    // with `ThreadPool::execute_on`, and deferred tasks are not limited.
+    size_t queue_capacity{0};
+    // What `ThreadPool::execute` does with a task that finds the queue of its thread full.
+    OverflowPolicy overflow_policy{OverflowPolicy::block};
+    // What threads do once they run out of work.
+    WaitStrategy wait_strategy{WaitStrategy::adaptive};
+    // CPUs on which each thread may run: thread `i` is pinned to the CPUs in `cpu_affinity[i]`.
+    // Threads with an empty set, or past the end of the list, are not pinned. Pinning is only
+    // supported on Linux, and is ignored elsewhere.
+    std::vector<std::vector<uint32_t>> cpu_affinity{};
+    // Spreads the threads evenly across the NUMA nodes of the system, and pins each thread that has
+    // no CPUs in `cpu_affinity` to the CPUs of its node.
+    bool numa_aware{false};
+    // Threads are named `<thread_name>-<index>`. Linux truncates names to 15 characters.
+    std::string thread_name{"spindle"};
+    // Stack size of each thread in bytes, or zero for the platform's default.
+    size_t stack_size{0};
+    // Number of tasks each thread keeps a record of for `ThreadPool::write_trace`, or zero to
+    // disable tracing. A record holds when a task was queued, started and ended, and costs two
+    // clock reads per task. Tracing is compiled out, and this option ignored, unless the library
+    // is built with `SPINDLE_TRACING`.
+    size_t trace_capacity{0};
+};
+
+} // namespace spindle
+
+#endif // SPINDLE_THREAD_POOL_OPTIONS_H_
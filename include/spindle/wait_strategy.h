@@ -0,0 +1,20 @@
+#ifndef SPINDLE_WAIT_STRATEGY_H_
+#define SPINDLE_WAIT_STRATEGY_H_
+
+namespace spindle {
+
+// `WaitStrategy` determines what a thread of a `ThreadPool` does once it runs out of work.
+enum class WaitStrategy {
+    // Block right away. This wastes no CPU time, but every task that arrives at an idle thread
+    // pays for a wakeup by the operating system.
+    park,
+    // Spin for a while, then yield the processor a few times, and then block. The time spent
+    // spinning adapts to how often work has recently arrived while spinning.
+    adaptive,
+    // Never block, which gives the lowest latency at the cost of keeping a core busy per thread.
+    spin,
+};
+
+} // namespace spindle
+
+#endif // SPINDLE_WAIT_STRATEGY_H_
@@ -0,0 +1,54 @@
+#include "spindle/barrier.h"
+
+#include <sstream>
+#include <stdexcept>
+
+#include "futex.h"
+
+namespace spindle {
+
+constexpr uint32_t Barrier::waiting;
+
+Barrier::Barrier(uint32_t count) : remaining(count), expected(count) {
+    if (count <= 0) {
+        std::stringstream s;
+        s << "Barrier thread count must be positive: " << count;
+        throw std::runtime_error{s.str()};
+    }
+}
+
+void Barrier::arrive_and_wait() {
+    // The phase cannot advance before this thread arrives, so it is read first.
+    uint32_t p = phase.load(std::memory_order_acquire) & ~waiting;
+    if (arrive(p, false)) return;
+
+    uint32_t s = phase.load(std::memory_order_acquire);
+    while ((s & ~waiting) == p) {
+        if ((s & waiting) == 0 &&
+            !phase.compare_exchange_weak(
+                s, s | waiting, std::memory_order_acquire, std::memory_order_acquire)) {
+            continue;
+        }
+        futex::wait(phase, s | waiting);
+        s = phase.load(std::memory_order_acquire);
+    }
+}
+
+void Barrier::arrive_and_drop() {
+    uint32_t p = phase.load(std::memory_order_acquire) & ~waiting;
+    arrive(p, true);
+}
+
+bool Barrier::arrive(uint32_t p, bool drop) {
+    if (drop) expected.fetch_sub(1, std::memory_order_relaxed);
+    if (remaining.fetch_sub(1, std::memory_order_acq_rel) != 1) return false;
+
+    // Reset the count before publishing the next phase, since threads may arrive in it as soon as
+    // they observe it.
+    remaining.store(expected.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    uint32_t old = phase.exchange(p + 2, std::memory_order_acq_rel);
+    if ((old & waiting) != 0) futex::wake_all(phase);
+    return true;
+}
+
+} // namespace spindle
@@ -0,0 +1,65 @@
+#ifndef SPINDLE_EVENT_COUNT_H_
+#define SPINDLE_EVENT_COUNT_H_
+
+#include <atomic>
+#include <cstdint>
+
+#include "futex.h"
+#include "timer_wheel.h"
+
+namespace spindle {
+
+// `EventCount` lets a thread block until a condition that other threads establish without a lock
+// becomes true. The waiting thread calls `prepare_wait`, re-checks the condition, and then either
+// calls `cancel_wait` or `wait`. A thread that establishes the condition calls `notify`, which is
+// a fence and a load unless a thread is blocked, so signalling is cheap when nobody waits.
+class EventCount {
+  public:
+    using Key = uint32_t;
+
+    Key prepare_wait() {
+        waiters.fetch_add(1, std::memory_order_seq_cst);
+        return epoch.load(std::memory_order_seq_cst);
+    }
+
+    void cancel_wait() {
+        waiters.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    // Blocks until `notify` is called after the `prepare_wait` that returned `key`, or until
+    // `deadline`.
+    void wait(Key key, clock::time_point deadline) {
+        while (epoch.load(std::memory_order_acquire) == key) {
+            if (deadline == clock::time_point::max()) {
+                futex::wait(epoch, key);
+                continue;
+            }
+            clock::time_point now = clock::now();
+            if (now >= deadline) break;
+            futex::wait_for(epoch, key, deadline - now);
+        }
+        waiters.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    // Wakes up the threads blocked in `wait`. Pairs with `prepare_wait`: either the notifying
+    // thread observes a waiter, or the waiter observes the condition when it re-checks it.
+    void notify() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        notify_fenced();
+    }
+
+    // Same as `notify`, for a caller that has just issued a sequentially consistent fence.
+    void notify_fenced() {
+        if (waiters.load(std::memory_order_relaxed) == 0) return;
+        epoch.fetch_add(1, std::memory_order_seq_cst);
+        futex::wake_all(epoch);
+    }
+
+  private:
+    std::atomic_uint32_t epoch{};
+    std::atomic_uint32_t waiters{};
+};
+
+} // namespace spindle
+
+#endif // SPINDLE_EVENT_COUNT_H_
@@ -0,0 +1,96 @@
+#include "futex.h"
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <climits>
+#include <ctime>
+#else
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#endif
+
+namespace spindle {
+
+namespace futex {
+
+#if defined(__linux__)
+
+namespace {
+
+long futex(const std::atomic_uint32_t& word,
+           int op,
+           uint32_t val,
+           const struct timespec* timeout = nullptr) {
+    static_assert(sizeof(std::atomic_uint32_t) == sizeof(uint32_t), "Futex word must be 32 bits");
+    return syscall(SYS_futex, &word, op, val, timeout, nullptr, 0);
+}
+
+} // namespace
+
+void wait(const std::atomic_uint32_t& word, uint32_t expected) {
+    futex(word, FUTEX_WAIT_PRIVATE, expected);
+}
+
+void wait_for(const std::atomic_uint32_t& word,
+              uint32_t expected,
+              std::chrono::nanoseconds timeout) {
+    struct timespec ts;
+    ts.tv_sec = std::chrono::duration_cast<std::chrono::seconds>(timeout).count();
+    ts.tv_nsec = (timeout % std::chrono::seconds{1}).count();
+    futex(word, FUTEX_WAIT_PRIVATE, expected, &ts);
+}
+
+void wake_all(const std::atomic_uint32_t& word) {
+    futex(word, FUTEX_WAKE_PRIVATE, INT_MAX);
+}
+
+#else
+
+namespace {
+
+// Without futexes, waiters park on a condition variable picked by hashing the address of the word.
+// The buckets are never destroyed, so waking a word that no longer exists is harmless.
+struct Bucket {
+    std::mutex m;
+    std::condition_variable cv;
+};
+
+constexpr size_t num_buckets = 64;
+
+Bucket& bucket(const std::atomic_uint32_t& word) {
+    static Bucket* const buckets = new Bucket[num_buckets];
+    return buckets[std::hash<const void*>{}(&word) % num_buckets];
+}
+
+} // namespace
+
+void wait(const std::atomic_uint32_t& word, uint32_t expected) {
+    Bucket& b = bucket(word);
+    std::unique_lock<std::mutex> lk{b.m};
+    if (word.load() == expected) b.cv.wait(lk);
+}
+
+void wait_for(const std::atomic_uint32_t& word,
+              uint32_t expected,
+              std::chrono::nanoseconds timeout) {
+    Bucket& b = bucket(word);
+    std::unique_lock<std::mutex> lk{b.m};
+    if (word.load() == expected) b.cv.wait_for(lk, timeout);
+}
+
+void wake_all(const std::atomic_uint32_t& word) {
+    Bucket& b = bucket(word);
+    std::lock_guard<std::mutex> lk{b.m};
+    b.cv.notify_all();
+}
+
+#endif
+
+} // namespace futex
+
+} // namespace spindle
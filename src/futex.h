@@ -0,0 +1,28 @@
+#ifndef SPINDLE_FUTEX_H_
+#define SPINDLE_FUTEX_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace spindle {
+
+namespace futex {
+
+// Blocks the calling thread as long as `word` holds `expected`. The check and the block are atomic
+// with respect to `wake`, but the thread may also wake up spuriously, so callers must re-check
+// their condition in a loop.
+void wait(const std::atomic_uint32_t& word, uint32_t expected);
+// Like `wait`, but returns once `timeout` has elapsed.
+void wait_for(const std::atomic_uint32_t& word,
+              uint32_t expected,
+              std::chrono::nanoseconds timeout);
+// Wakes up all threads blocked in `wait` on `word`. It is safe to call this method on a word whose
+// storage has been released, as long as it is not being waited on any longer.
+void wake_all(const std::atomic_uint32_t& word);
+
+} // namespace futex
+
+} // namespace spindle
+
+#endif // SPINDLE_FUTEX_H_
@@ -3,28 +3,59 @@
 #include <sstream>
 #include <stdexcept>
 
+#include "futex.h"
+
 namespace spindle {
 
+constexpr uint32_t Latch::max_weight;
+constexpr uint32_t Latch::waiting;
+
 Latch::Latch() : Latch(1) {}
 
-Latch::Latch(uint32_t weight) : weight(weight) {
-    if (weight <= 0) {
+Latch::Latch(uint32_t weight) : state(weight) {
+    if (weight <= 0 || weight > max_weight) {
         std::stringstream s;
-        s << "Latch weight must be positive: " << weight;
+        s << "Latch weight must be positive and at most " << max_weight << ": " << weight;
         throw std::runtime_error{s.str()};
     }
 }
 
 void Latch::decrement() {
-    std::lock_guard<std::mutex> lk{m};
-    // Prevent potential underflow of `weight`.
-    if (weight == 0 || --weight > 0) return;
-    cv.notify_all();
+    count_down(1);
+}
+
+void Latch::count_down(uint32_t n) {
+    uint32_t s = state.load(std::memory_order_relaxed);
+    uint32_t weight;
+    do {
+        // Prevent potential underflow of the weight.
+        weight = s & ~waiting;
+        if (weight == 0 || n == 0) return;
+    } while (!state.compare_exchange_weak(s,
+                                          (s & waiting) | (weight > n ? weight - n : 0),
+                                          std::memory_order_acq_rel,
+                                          std::memory_order_relaxed));
+
+    // The `Latch` may have been destroyed once the weight reached zero, so only its address is
+    // used from here on.
+    if (weight <= n && (s & waiting) != 0) futex::wake_all(state);
+}
+
+bool Latch::try_wait() const {
+    return (state.load(std::memory_order_acquire) & ~waiting) == 0;
 }
 
 void Latch::wait() {
-    std::unique_lock<std::mutex> lk{m};
-    cv.wait(lk, [&] { return weight == 0; });
+    uint32_t s = state.load(std::memory_order_acquire);
+    while ((s & ~waiting) != 0) {
+        if ((s & waiting) == 0 &&
+            !state.compare_exchange_weak(
+                s, s | waiting, std::memory_order_acquire, std::memory_order_acquire)) {
+            continue;
+        }
+        futex::wait(state, s | waiting);
+        s = state.load(std::memory_order_acquire);
+    }
 }
 
 } // namespace spindle
@@ -0,0 +1,163 @@
+#include "spindle/metrics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <ostream>
+#include <sstream>
+
+namespace spindle {
+
+namespace {
+
+const char* const priority_names[num_priorities] = {"critical", "normal", "background"};
+
+// Bounds of the buckets of exported histograms, as powers of two of nanoseconds, from about a
+// microsecond to about half a minute. They coincide with bounds of `Histogram` buckets.
+constexpr size_t min_exported_bound = 10;
+constexpr size_t max_exported_bound = 35;
+
+double seconds(std::chrono::nanoseconds value) {
+    return std::chrono::duration<double>(value).count();
+}
+
+void header(std::ostream& out, const std::string& name, const char* type, const char* help) {
+    out << "# HELP " << name << " " << help << "\n";
+    out << "# TYPE " << name << " " << type << "\n";
+}
+
+template <class F>
+void per_worker(std::ostream& out,
+                const Metrics& metrics,
+                const std::string& name,
+                const char* type,
+                const char* help,
+                F value) {
+    header(out, name, type, help);
+    for (size_t i = 0; i < metrics.workers.size(); ++i) {
+        out << name << "{worker=\"" << i << "\"} " << value(metrics.workers[i]) << "\n";
+    }
+}
+
+} // namespace
+
+std::chrono::nanoseconds Histogram::lower_bound(size_t bucket) {
+    if (bucket < 4) return std::chrono::nanoseconds{static_cast<int64_t>(bucket)};
+    uint64_t sub_bucket = 4 + bucket % 4;
+    return std::chrono::nanoseconds{static_cast<int64_t>(sub_bucket << (bucket / 4 - 1))};
+}
+
+void Histogram::add(std::chrono::nanoseconds value) {
+    counts[bucket(value)]++;
+    sum += value;
+}
+
+uint64_t Histogram::count() const {
+    uint64_t n = 0;
+    for (uint64_t c : counts) {
+        n += c;
+    }
+    return n;
+}
+
+std::chrono::nanoseconds Histogram::quantile(double q) const {
+    uint64_t n = count();
+    if (n == 0) return std::chrono::nanoseconds{0};
+    uint64_t rank = std::max<uint64_t>(static_cast<uint64_t>(std::ceil(q * n)), 1);
+    uint64_t seen = 0;
+    for (size_t b = 0; b < num_buckets; ++b) {
+        seen += counts[b];
+        if (seen < rank) continue;
+        if (b + 1 == num_buckets) return std::chrono::nanoseconds::max();
+        return lower_bound(b + 1);
+    }
+    return std::chrono::nanoseconds::max();
+}
+
+Histogram& Histogram::operator+=(const Histogram& other) {
+    for (size_t b = 0; b < num_buckets; ++b) {
+        counts[b] += other.counts[b];
+    }
+    sum += other.sum;
+    return *this;
+}
+
+Histogram Metrics::queueing_delay(Priority priority) const {
+    Histogram delay;
+    for (const WorkerMetrics& worker : workers) {
+        delay += worker.queueing_delay[static_cast<size_t>(priority)];
+    }
+    return delay;
+}
+
+std::string Metrics::to_prometheus(const std::string& prefix) const {
+    std::stringstream out;
+    // Nanosecond resolution for durations of up to a few minutes, which covers every bucket bound.
+    out.precision(12);
+
+    header(out, prefix + "_threads", "gauge", "Threads that are running.");
+    out << prefix << "_threads " << threads << "\n";
+
+    per_worker(out, *this, prefix + "_queued_tasks", "gauge",
+               "Immediate tasks waiting in the queues of a thread.",
+               [](const WorkerMetrics& w) { return w.queued; });
+    std::string name = prefix + "_queue_depth";
+    header(out, name, "gauge",
+           "Immediate tasks of a priority class waiting in the queues of a thread.");
+    for (size_t i = 0; i < workers.size(); ++i) {
+        for (size_t p = 0; p < num_priorities; ++p) {
+            out << name << "{worker=\"" << i << "\",priority=\"" << priority_names[p] << "\"} "
+                << workers[i].queue_depth[p] << "\n";
+        }
+    }
+    if (queue_capacity != 0) {
+        header(out, prefix + "_queue_capacity", "gauge",
+               "Immediate tasks of a priority class a thread can queue.");
+        out << prefix << "_queue_capacity " << queue_capacity << "\n";
+    }
+    per_worker(out, *this, prefix + "_deferred_tasks", "gauge",
+               "Deferred tasks waiting for their deadline on a thread.",
+               [](const WorkerMetrics& w) { return w.deferred; });
+    per_worker(out, *this, prefix + "_tasks_executed_total", "counter",
+               "Tasks run by a thread.",
+               [](const WorkerMetrics& w) { return w.executed; });
+    per_worker(out, *this, prefix + "_tasks_stolen_total", "counter",
+               "Tasks a thread stole from others.",
+               [](const WorkerMetrics& w) { return w.stolen; });
+    per_worker(out, *this, prefix + "_tasks_overflowed_total", "counter",
+               "Tasks that found a queue of a thread full.",
+               [](const WorkerMetrics& w) { return w.overflowed; });
+    per_worker(out, *this, prefix + "_tasks_dropped_total", "counter",
+               "Queued tasks a thread discarded to make room for newer ones.",
+               [](const WorkerMetrics& w) { return w.dropped; });
+    per_worker(out, *this, prefix + "_busy_seconds_total", "counter",
+               "Time a thread spent looking for and running tasks.",
+               [](const WorkerMetrics& w) { return seconds(w.busy_time); });
+    per_worker(out, *this, prefix + "_idle_seconds_total", "counter",
+               "Time a thread spent waiting for work.",
+               [](const WorkerMetrics& w) { return seconds(w.idle_time); });
+
+    name = prefix + "_queueing_delay_seconds";
+    header(out, name, "histogram", "Time immediate tasks waited in a queue before they started.");
+    for (size_t p = 0; p < num_priorities; ++p) {
+        Histogram delay = queueing_delay(static_cast<Priority>(p));
+        std::string labels = std::string{"priority=\""} + priority_names[p] + "\"";
+        uint64_t below = 0;
+        size_t b = 0;
+        for (size_t bound = min_exported_bound; bound <= max_exported_bound; ++bound) {
+            // The first bucket whose lower bound is 2^bound.
+            for (size_t end = (bound - 1) * 4; b < end; ++b) {
+                below += delay.counts[b];
+            }
+            out << name << "_bucket{" << labels << ",le=\""
+                << seconds(std::chrono::nanoseconds{int64_t{1} << bound}) << "\"} " << below
+                << "\n";
+        }
+        uint64_t total = delay.count();
+        out << name << "_bucket{" << labels << ",le=\"+Inf\"} " << total << "\n";
+        out << name << "_sum{" << labels << "} " << seconds(delay.sum) << "\n";
+        out << name << "_count{" << labels << "} " << total << "\n";
+    }
+    return out.str();
+}
+
+} // namespace spindle
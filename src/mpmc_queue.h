@@ -0,0 +1,167 @@
+#ifndef SPINDLE_MPMC_QUEUE_H_
+#define SPINDLE_MPMC_QUEUE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+namespace spindle {
+
+// `MpmcQueue` is a bounded, lock-free, multi-producer multi-consumer FIFO queue backed by a ring of
+// cells. Each cell carries a sequence number that tells producers and consumers whether it is free
+// or holds a published element, so neither side ever takes a lock. The capacity must be a power of
+// two.
+template <class T>
+class MpmcQueue {
+  public:
+    explicit MpmcQueue(size_t capacity);
+
+    MpmcQueue(const MpmcQueue&) = delete;
+    MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+    // Appends `value` to the queue. Returns false, leaving `value` untouched, if the queue is full.
+    template <class U>
+    bool push(U&& value);
+    // Moves a prefix of the `count` elements at `values`, which is a pointer or any other type that
+    // can be subscripted, to the queue, claiming all of their cells at once. Returns the length of
+    // the prefix, which is shorter than `count` if the queue fills.
+    template <class U>
+    size_t push_bulk(U values, size_t count);
+    // Removes the element at the front of the queue and stores it in `value`. Returns false if no
+    // published element is available.
+    bool pop(T& value);
+    // Returns true if there is no published element at the front of the queue. The result is only
+    // a snapshot when other threads are pushing or popping concurrently.
+    bool empty() const;
+    // Returns the number of elements in the queue, counting those that are being pushed or popped
+    // concurrently. The result is only a snapshot, like `empty`.
+    size_t size() const;
+
+  private:
+    static constexpr size_t cache_line_sz = 64;
+
+    struct Cell {
+        std::atomic<size_t> seq;
+        T value;
+    };
+
+    std::unique_ptr<Cell[]> cells;
+    size_t mask;
+    alignas(cache_line_sz) std::atomic<size_t> enqueue_pos;
+    alignas(cache_line_sz) std::atomic<size_t> dequeue_pos;
+};
+
+template <class T>
+MpmcQueue<T>::MpmcQueue(size_t capacity) : mask(capacity - 1), enqueue_pos(0), dequeue_pos(0) {
+    if (capacity < 2 || (capacity & (capacity - 1)) != 0) {
+        std::stringstream s;
+        s << "Queue capacity must be a power of two: " << capacity;
+        throw std::runtime_error{s.str()};
+    }
+    cells.reset(new Cell[capacity]);
+    for (size_t i = 0; i < capacity; ++i) {
+        cells[i].seq.store(i, std::memory_order_relaxed);
+    }
+}
+
+template <class T>
+template <class U>
+bool MpmcQueue<T>::push(U&& value) {
+    Cell* cell;
+    size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+    for (;;) {
+        cell = &cells[pos & mask];
+        size_t seq = cell->seq.load(std::memory_order_acquire);
+        intptr_t dif = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+        if (dif == 0) {
+            if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+        } else if (dif < 0) {
+            return false; // Full.
+        } else {
+            pos = enqueue_pos.load(std::memory_order_relaxed);
+        }
+    }
+
+    cell->value = std::forward<U>(value);
+    cell->seq.store(pos + 1, std::memory_order_release);
+
+    return true;
+}
+
+template <class T>
+template <class U>
+size_t MpmcQueue<T>::push_bulk(U values, size_t count) {
+    size_t n;
+    size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+    for (;;) {
+        // Count the free cells from `pos` onwards. A cell that is free for its position can only be
+        // claimed by moving `enqueue_pos` past it, so they stay free if the exchange succeeds.
+        intptr_t dif = 0;
+        for (n = 0; n < count && n <= mask; ++n) {
+            size_t seq = cells[(pos + n) & mask].seq.load(std::memory_order_acquire);
+            dif = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + n);
+            if (dif != 0) break;
+        }
+
+        if (n > 0) {
+            if (enqueue_pos.compare_exchange_weak(pos, pos + n, std::memory_order_relaxed)) break;
+        } else if (dif < 0) {
+            return 0; // Full.
+        } else {
+            pos = enqueue_pos.load(std::memory_order_relaxed);
+        }
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+        Cell& cell = cells[(pos + i) & mask];
+        cell.value = std::move(values[i]);
+        cell.seq.store(pos + i + 1, std::memory_order_release);
+    }
+
+    return n;
+}
+
+template <class T>
+bool MpmcQueue<T>::pop(T& value) {
+    Cell* cell;
+    size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+    for (;;) {
+        cell = &cells[pos & mask];
+        size_t seq = cell->seq.load(std::memory_order_acquire);
+        intptr_t dif = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+        if (dif == 0) {
+            if (dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+        } else if (dif < 0) {
+            return false; // Empty, or the producer has not published the element yet.
+        } else {
+            pos = dequeue_pos.load(std::memory_order_relaxed);
+        }
+    }
+
+    value = std::move(cell->value);
+    cell->seq.store(pos + mask + 1, std::memory_order_release);
+
+    return true;
+}
+
+template <class T>
+bool MpmcQueue<T>::empty() const {
+    size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+    return cells[pos & mask].seq.load(std::memory_order_acquire) != pos + 1;
+}
+
+template <class T>
+size_t MpmcQueue<T>::size() const {
+    // The consumer position is read first, so that it cannot overtake the producer position.
+    size_t first = dequeue_pos.load(std::memory_order_acquire);
+    size_t last = enqueue_pos.load(std::memory_order_acquire);
+    return last - first;
+}
+
+} // namespace spindle
+
+#endif // SPINDLE_MPMC_QUEUE_H_
@@ -0,0 +1,141 @@
+#include "scheduler.h"
+
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+namespace spindle {
+
+Scheduler::Scheduler(clock::duration resolution,
+                     std::function<void(Task)> dispatch,
+                     const Thread::Attributes& attributes)
+    : dispatch(std::move(dispatch)), timers{resolution} {
+    thread = std::make_unique<Thread>([this] { run(); }, attributes);
+}
+
+Scheduler::~Scheduler() {
+    stop();
+}
+
+TaskHandle Scheduler::schedule_after(Task func, clock::duration delay) {
+    auto cancel = detail::make_cancel_state(tombstones);
+    std::lock_guard<std::mutex> lk{m};
+    if (!insert({std::move(func), clock::now() + delay, {}, false, cancel})) return {};
+    return TaskHandle{std::move(cancel)};
+}
+
+TaskHandle Scheduler::schedule_periodic(Task func,
+                                        clock::duration initial_delay,
+                                        clock::duration period,
+                                        bool fixed_rate,
+                                        MissedRunPolicy policy) {
+    if (period <= clock::duration::zero()) {
+        std::stringstream s;
+        s << "Scheduled task period must be positive: " << period.count();
+        throw std::runtime_error{s.str()};
+    }
+
+    auto cancel = detail::make_cancel_state(tombstones);
+    auto periodic = std::make_shared<Periodic>(Periodic{
+        std::move(func), clock::now() + initial_delay, period, fixed_rate, policy, cancel});
+    std::lock_guard<std::mutex> lk{m};
+    if (!insert({run_of(periodic), periodic->deadline, period, true, cancel})) return {};
+    return TaskHandle{std::move(cancel)};
+}
+
+void Scheduler::drain() {
+    {
+        std::lock_guard<std::mutex> lk{m};
+        draining = true;
+        // Tombstones are no longer counted, as nothing is scheduled from now on.
+        timers.remove_if(
+            [](const Timer& timer) { return timer.periodic || timer.cancel->cancelled(); });
+        cv.notify_one();
+    }
+    if (thread->joinable()) thread->join();
+}
+
+void Scheduler::stop() {
+    {
+        std::lock_guard<std::mutex> lk{m};
+        stopped = true;
+        cv.notify_one();
+    }
+    if (thread->joinable()) thread->join();
+}
+
+void Scheduler::run() {
+    std::unique_lock<std::mutex> lk{m};
+    Timer timer;
+    while (!stopped) {
+        collect_tombstones();
+        if (timers.poll(clock::now(), timer)) {
+            if (!claim(timer)) continue;
+            lk.unlock();
+            dispatch(std::move(timer.func));
+            lk.lock();
+            continue;
+        }
+
+        if (draining && timers.empty()) return;
+        clock::time_point deadline = timers.next_deadline();
+        if (deadline == clock::time_point::max()) {
+            cv.wait(lk);
+        } else {
+            cv.wait_until(lk, deadline);
+        }
+    }
+}
+
+bool Scheduler::insert(Timer timer) {
+    if (draining || stopped) return false;
+
+    clock::time_point earliest = timers.next_deadline();
+    timers.insert(std::move(timer));
+    // The thread only needs to wake up early for a task that is due before the one it waits for.
+    if (timers.next_deadline() < earliest) cv.notify_one();
+    return true;
+}
+
+void Scheduler::reschedule(const std::shared_ptr<Periodic>& periodic) {
+    clock::time_point now = clock::now();
+    Periodic& p = *periodic;
+    if (!p.fixed_rate) {
+        p.deadline = now + p.period;
+    } else {
+        p.deadline += p.period;
+        if (p.policy == MissedRunPolicy::skip && p.deadline < now) {
+            p.deadline += ((now - p.deadline) / p.period + 1) * p.period;
+        }
+    }
+
+    std::lock_guard<std::mutex> lk{m};
+    if (p.cancel->cancelled()) {
+        tombstones->fetch_sub(1, std::memory_order_relaxed);
+        return;
+    }
+    insert({run_of(periodic), p.deadline, p.period, true, p.cancel});
+}
+
+Task Scheduler::run_of(const std::shared_ptr<Periodic>& periodic) {
+    return [this, periodic] {
+        // The task may have been cancelled after it was dispatched.
+        if (!periodic->cancel->cancelled()) periodic->func();
+        reschedule(periodic);
+    };
+}
+
+bool Scheduler::claim(Timer& timer) {
+    if (timer.periodic ? !timer.cancel->cancelled() : timer.cancel->start()) return true;
+    tombstones->fetch_sub(1, std::memory_order_relaxed);
+    return false;
+}
+
+void Scheduler::collect_tombstones() {
+    int64_t n = tombstones->load(std::memory_order_relaxed);
+    if (n < min_tombstones || static_cast<uint64_t>(n) * 2 < timers.size()) return;
+    size_t removed = timers.remove_if([](const Timer& timer) { return timer.cancel->cancelled(); });
+    tombstones->fetch_sub(removed, std::memory_order_relaxed);
+}
+
+} // namespace spindle
@@ -0,0 +1,100 @@
+#ifndef SPINDLE_SCHEDULER_H_
+#define SPINDLE_SCHEDULER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+#include "spindle/missed_run_policy.h"
+#include "spindle/task.h"
+#include "spindle/task_handle.h"
+
+#include "thread.h"
+#include "timer_wheel.h"
+
+namespace spindle {
+
+// `Scheduler` keeps the tasks of a `ThreadPool` that are scheduled for later on a thread of its
+// own, and hands each task to `dispatch` once it is due. Periodic tasks are rescheduled once a run
+// completes, so the runs of a task never overlap.
+class Scheduler {
+  public:
+    // Creates a `Scheduler` whose tasks are due with the given precision, and starts its thread.
+    Scheduler(clock::duration resolution,
+              std::function<void(Task)> dispatch,
+              const Thread::Attributes& attributes);
+    // Stops the `Scheduler`.
+    ~Scheduler();
+
+    Scheduler(const Scheduler&) = delete;
+    Scheduler& operator=(const Scheduler&) = delete;
+
+    // Schedules a task that runs once `delay` has elapsed. Returns a handle that cancels the task
+    // until it is due, which refers to no task if the `Scheduler` is draining or stopped.
+    TaskHandle schedule_after(Task func, clock::duration delay);
+    // Schedules a task that runs once `initial_delay` has elapsed, and then every `period` if
+    // `fixed_rate` is set, or `period` after each run completes otherwise. Throws
+    // `std::runtime_error` if `period` is not positive.
+    TaskHandle schedule_periodic(Task func,
+                                 clock::duration initial_delay,
+                                 clock::duration period,
+                                 bool fixed_rate,
+                                 MissedRunPolicy policy);
+
+    // Rejects new tasks and discards the periodic ones, and then blocks until the tasks that run
+    // once are dispatched.
+    void drain();
+    // Rejects new tasks and discards the pending ones, and then blocks until the thread of the
+    // `Scheduler` exits.
+    void stop();
+
+  private:
+    // Cancelled tasks are left in the timer wheel until they come up, unless there are at least
+    // this many and they make up half of the wheel.
+    static constexpr int64_t min_tombstones = 64;
+
+    // A periodic task, which is shared by its runs.
+    struct Periodic {
+        Task func;
+        // When the next run is due.
+        clock::time_point deadline;
+        clock::duration period;
+        bool fixed_rate;
+        MissedRunPolicy policy;
+        std::shared_ptr<detail::CancelState> cancel;
+    };
+
+    std::function<void(Task)> dispatch;
+    TimerWheel timers;
+    // Number of cancelled tasks in `timers`, which is incremented by whoever cancels them.
+    std::shared_ptr<std::atomic<int64_t>> tombstones{std::make_shared<std::atomic<int64_t>>(0)};
+    // Guards `timers`, `draining` and `stopped`.
+    std::mutex m;
+    std::condition_variable cv;
+    bool draining{false};
+    bool stopped{false};
+    // Joined by `drain` or `stop`.
+    std::unique_ptr<Thread> thread;
+
+    void run();
+    // Adds `timer` to the wheel, waking the thread if it is now the earliest. Returns false if
+    // the `Scheduler` is draining or stopped. Must be called with `m` held.
+    bool insert(Timer timer);
+    // Queues the next run of `periodic`, which just completed.
+    void reschedule(const std::shared_ptr<Periodic>& periodic);
+    // Returns the task that runs `periodic` and then reschedules it.
+    Task run_of(const std::shared_ptr<Periodic>& periodic);
+    // Returns false, and forgets the tombstone, if `timer` was cancelled. Otherwise, a `timer` that
+    // runs once can no longer be cancelled.
+    bool claim(Timer& timer);
+    // Removes the cancelled tasks from `timers` if they make up most of it. Must be called with `m`
+    // held.
+    void collect_tombstones();
+};
+
+} // namespace spindle
+
+#endif // SPINDLE_SCHEDULER_H_
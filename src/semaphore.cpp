@@ -0,0 +1,71 @@
+#include "spindle/semaphore.h"
+
+#include <sstream>
+#include <stdexcept>
+
+#include "futex.h"
+
+namespace spindle {
+
+constexpr uint32_t Semaphore::max_count;
+constexpr uint32_t Semaphore::waiting;
+
+Semaphore::Semaphore(uint32_t count) : state(count) {
+    if (count > max_count) {
+        std::stringstream s;
+        s << "Semaphore count must be at most " << max_count << ": " << count;
+        throw std::runtime_error{s.str()};
+    }
+}
+
+void Semaphore::release(uint32_t n) {
+    uint32_t s = state.load(std::memory_order_relaxed);
+    do {
+        if (n > max_count - (s & ~waiting)) {
+            std::stringstream e;
+            e << "Semaphore count must be at most " << max_count << ": " << (s & ~waiting)
+              << " + " << n;
+            throw std::runtime_error{e.str()};
+        }
+    } while (!state.compare_exchange_weak(
+        s, (s & ~waiting) + n, std::memory_order_release, std::memory_order_relaxed));
+
+    // Clearing the flag means that blocked threads cannot rely on a later `release` to wake them,
+    // so all of them are woken here. The ones that find the count exhausted block again.
+    if ((s & waiting) != 0) futex::wake_all(state);
+}
+
+void Semaphore::acquire() {
+    uint32_t s = state.load(std::memory_order_relaxed);
+    for (;;) {
+        if ((s & ~waiting) != 0) {
+            if (state.compare_exchange_weak(
+                    s, s - 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+                return;
+            }
+            continue;
+        }
+        if ((s & waiting) == 0) {
+            if (!state.compare_exchange_weak(
+                    s, s | waiting, std::memory_order_relaxed, std::memory_order_relaxed)) {
+                continue;
+            }
+            s |= waiting;
+        }
+        futex::wait(state, s);
+        s = state.load(std::memory_order_relaxed);
+    }
+}
+
+bool Semaphore::try_acquire() {
+    uint32_t s = state.load(std::memory_order_relaxed);
+    while ((s & ~waiting) != 0) {
+        if (state.compare_exchange_weak(
+                s, s - 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace spindle
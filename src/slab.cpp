@@ -0,0 +1,189 @@
+#include "spindle/slab.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace spindle {
+
+namespace detail {
+
+namespace {
+
+constexpr size_t cache_line_sz = 64;
+// Blocks of class `c` are `min_block_size << c` bytes long, header included.
+constexpr size_t min_block_size = 64;
+constexpr size_t num_classes = 6;
+constexpr size_t chunk_size = 64 * 1024;
+
+class Arena;
+
+// Precedes every block, so that a block can be returned to its arena from any thread. Blocks from
+// the global allocator have no arena. The header of a slab block is written once, when its chunk is
+// carved, and a free block links to the next one past its header.
+struct alignas(std::max_align_t) Header {
+    Arena* arena;
+    size_t cls;
+};
+
+static_assert(sizeof(Header) + max_slab_size == min_block_size << (num_classes - 1),
+              "The largest slab block must hold the largest slab allocation");
+
+struct FreeBlock {
+    FreeBlock* next;
+};
+
+Header* header_of(void* p) {
+    return static_cast<Header*>(p) - 1;
+}
+
+size_t class_of(size_t size) {
+    size_t cls = 0;
+    while ((min_block_size << cls) < size + sizeof(Header)) {
+        cls++;
+    }
+    return cls;
+}
+
+class Arena {
+  public:
+    void* allocate(size_t cls) {
+        FreeBlock* block = local[cls];
+        if (block == nullptr) block = remote[cls].list.exchange(nullptr, std::memory_order_acquire);
+        if (block == nullptr) block = carve(cls);
+        local[cls] = block->next;
+        return block;
+    }
+
+    // Must only be called by the thread that owns the arena.
+    void deallocate_local(void* p) {
+        FreeBlock* block = static_cast<FreeBlock*>(p);
+        size_t cls = header_of(p)->cls;
+        block->next = local[cls];
+        local[cls] = block;
+    }
+
+    void deallocate_remote(void* p) {
+        FreeBlock* block = static_cast<FreeBlock*>(p);
+        std::atomic<FreeBlock*>& list = remote[header_of(p)->cls].list;
+        block->next = list.load(std::memory_order_relaxed);
+        while (!list.compare_exchange_weak(
+            block->next, block, std::memory_order_release, std::memory_order_relaxed)) {
+        }
+    }
+
+    // Links the arenas of threads that exited.
+    Arena* next_abandoned{nullptr};
+
+  private:
+    // The blocks freed on other threads, on a cache line of their own per class so that those
+    // threads do not contend with each other or with the owner.
+    struct alignas(cache_line_sz) RemoteList {
+        std::atomic<FreeBlock*> list{nullptr};
+    };
+
+    FreeBlock* local[num_classes]{};
+    RemoteList remote[num_classes];
+    std::vector<std::unique_ptr<unsigned char[]>> chunks;
+
+    // Splits a new chunk into blocks of class `cls`, and returns the first of them.
+    FreeBlock* carve(size_t cls) {
+        size_t block_size = min_block_size << cls;
+        chunks.emplace_back(new unsigned char[chunk_size]);
+        unsigned char* chunk = chunks.back().get();
+        FreeBlock* first = nullptr;
+        for (size_t offset = chunk_size; offset >= block_size; offset -= block_size) {
+            Header* header = reinterpret_cast<Header*>(chunk + offset - block_size);
+            header->arena = this;
+            header->cls = cls;
+            FreeBlock* block = reinterpret_cast<FreeBlock*>(header + 1);
+            block->next = first;
+            first = block;
+        }
+        return first;
+    }
+};
+
+// Arenas whose thread exited, which are handed over to threads that start. Deliberately leaked, so
+// that blocks can still be freed while static objects are destroyed.
+struct Abandoned {
+    std::mutex m;
+    Arena* arenas{nullptr};
+};
+
+Abandoned& abandoned() {
+    static Abandoned* a = new Abandoned{};
+    return *a;
+}
+
+// Returns a new arena. Its storage is aligned explicitly, since `new` only honors the alignment of
+// its cache lines as of C++17.
+Arena* create_arena() {
+    void* storage = nullptr;
+    if (posix_memalign(&storage, alignof(Arena), sizeof(Arena)) != 0) throw std::bad_alloc{};
+    return new (storage) Arena{};
+}
+
+Arena* adopt() {
+    Abandoned& a = abandoned();
+    std::lock_guard<std::mutex> lk{a.m};
+    Arena* arena = a.arenas;
+    if (arena == nullptr) return create_arena();
+    a.arenas = arena->next_abandoned;
+    return arena;
+}
+
+// The arena of the calling thread, which is null until the thread first allocates, and once it is
+// exiting.
+thread_local Arena* local_arena = nullptr;
+thread_local bool exiting = false;
+
+// Abandons the arena of its thread once the thread exits.
+struct Owner {
+    ~Owner() {
+        exiting = true;
+        if (local_arena == nullptr) return;
+        Abandoned& a = abandoned();
+        std::lock_guard<std::mutex> lk{a.m};
+        local_arena->next_abandoned = a.arenas;
+        a.arenas = local_arena;
+        local_arena = nullptr;
+    }
+};
+
+Arena* arena() {
+    if (local_arena == nullptr && !exiting) {
+        thread_local Owner owner;
+        local_arena = adopt();
+    }
+    return local_arena;
+}
+
+} // namespace
+
+void* slab_allocate(size_t size) {
+    Arena* a = size <= max_slab_size ? arena() : nullptr;
+    if (a != nullptr) return a->allocate(class_of(size));
+    Header* header = static_cast<Header*>(::operator new(sizeof(Header) + size));
+    header->arena = nullptr;
+    return header + 1;
+}
+
+void slab_deallocate(void* p) noexcept {
+    if (p == nullptr) return;
+    Header* header = header_of(p);
+    if (header->arena == nullptr) {
+        ::operator delete(header);
+    } else if (header->arena == local_arena) {
+        header->arena->deallocate_local(p);
+    } else {
+        header->arena->deallocate_remote(p);
+    }
+}
+
+} // namespace detail
+
+} // namespace spindle
@@ -0,0 +1,154 @@
+#include "spindle/strand.h"
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <utility>
+
+#include "spindle/slab.h"
+
+namespace spindle {
+
+constexpr size_t Strand::batch_size;
+
+// `Queue` is an intrusive, multi-producer single-consumer list of tasks, where the consumer is
+// whichever thread runs the strand. The head is a node whose task already ran, or a stub. Producers
+// only swap the tail and then link the previous tail to their node, so a task may briefly be
+// counted in `pending` before it is reachable from the head.
+class Strand::Queue {
+  public:
+    explicit Queue(ThreadPool& pool) : pool(pool) {}
+
+    ~Queue() {
+        while (head != nullptr) {
+            delete std::exchange(head, head->next.load(std::memory_order_relaxed));
+        }
+    }
+
+    Queue(const Queue&) = delete;
+    Queue& operator=(const Queue&) = delete;
+
+    void push(const std::shared_ptr<Queue>& self, Task task) {
+        Node* node = new Node{std::move(task)};
+        Node* prev = tail.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+        // Only the producer that finds the strand without work schedules it.
+        if (pending.fetch_add(1, std::memory_order_acq_rel) == 0) schedule(self);
+    }
+
+    bool running_in_this_thread() const {
+        return current == this;
+    }
+
+  private:
+    struct Node {
+        Task func;
+        std::atomic<Node*> next{nullptr};
+
+        static void* operator new(size_t size) {
+            return detail::slab_allocate(size);
+        }
+
+        static void operator delete(void* p) noexcept {
+            detail::slab_deallocate(p);
+        }
+    };
+
+    // The strand that runs on this thread, if any.
+    static thread_local const Queue* current;
+
+    ThreadPool& pool;
+    Node* head{new Node{}};
+    std::atomic<Node*> tail{head};
+    // Number of queued tasks, including the one that is running.
+    std::atomic_size_t pending{0};
+
+    // `Run` is the task that runs the strand on the pool. If the pool drops it without running it,
+    // the tasks queued on the strand are dropped too, which leaves the strand without work so that
+    // the next task queued schedules it again.
+    class Run {
+      public:
+        explicit Run(std::shared_ptr<Queue> queue) : queue(std::move(queue)) {}
+
+        Run(Run&&) noexcept = default;
+        Run& operator=(Run&&) = delete;
+
+        ~Run() {
+            if (queue) queue->drop();
+        }
+
+        void operator()() {
+            std::shared_ptr<Queue> self = std::move(queue);
+            self->run(self);
+        }
+
+      private:
+        std::shared_ptr<Queue> queue;
+    };
+
+    void schedule(const std::shared_ptr<Queue>& self) {
+        pool.execute(Run{self});
+    }
+
+    // Runs up to `batch_size` tasks, and schedules the strand again if more remain. A task that
+    // throws counts as done, and the strand carries on with the rest on the pool.
+    void run(const std::shared_ptr<Queue>& self) {
+        struct Batch {
+            const std::shared_ptr<Queue>& self;
+            const Queue* prev;
+            bool more;
+
+            ~Batch() {
+                current = prev;
+                if (more) self->schedule(self);
+            }
+        } batch{self, std::exchange(current, this), true};
+
+        for (size_t i = 0; i < batch_size && batch.more; ++i) {
+            // Destroyed after `func`, so the task is gone before the next one may start.
+            struct Done {
+                Batch& batch;
+                std::atomic_size_t& pending;
+
+                ~Done() {
+                    batch.more = pending.fetch_sub(1, std::memory_order_acq_rel) != 1;
+                }
+            } done{batch, pending};
+            Task func = pop();
+            func();
+        }
+    }
+
+    // Drops the queued tasks in place of running them.
+    void drop() {
+        do {
+            pop();
+        } while (pending.fetch_sub(1, std::memory_order_acq_rel) != 1);
+    }
+
+    // Removes the task at the front of the queue, waiting for its producer to link it if needed.
+    // Must only be called while `pending` is not zero.
+    Task pop() {
+        Node* next = head->next.load(std::memory_order_acquire);
+        while (next == nullptr) {
+            std::this_thread::yield();
+            next = head->next.load(std::memory_order_acquire);
+        }
+        delete std::exchange(head, next);
+        return std::move(next->func);
+    }
+};
+
+thread_local const Strand::Queue* Strand::Queue::current = nullptr;
+
+Strand::Strand(ThreadPool& pool) : queue(std::make_shared<Queue>(pool)) {}
+
+void Strand::execute(Task task) {
+    queue->push(queue, std::move(task));
+}
+
+bool Strand::running_in_this_thread() const {
+    return queue->running_in_this_thread();
+}
+
+} // namespace spindle
@@ -0,0 +1,125 @@
+#include "spindle/task_graph.h"
+
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+namespace spindle {
+
+TaskGraph::NodeId TaskGraph::add(Task task, std::initializer_list<NodeId> predecessors) {
+    for (NodeId predecessor : predecessors) {
+        check(predecessor);
+    }
+
+    NodeId id = nodes.size();
+    nodes.push_back(std::unique_ptr<Node>{new Node{std::move(task), {}, 0, {0}}});
+    for (NodeId predecessor : predecessors) {
+        nodes[predecessor]->successors.push_back(id);
+        nodes[id]->num_predecessors++;
+    }
+    // A new node cannot close a cycle, so only its place among the roots needs updating.
+    if (validated && predecessors.size() == 0) roots.push_back(id);
+
+    return id;
+}
+
+void TaskGraph::add_dependency(NodeId node, NodeId predecessor) {
+    check(node);
+    check(predecessor);
+    if (node == predecessor) {
+        std::stringstream s;
+        s << "Task graph node cannot depend on itself: " << node;
+        throw std::runtime_error{s.str()};
+    }
+
+    nodes[predecessor]->successors.push_back(node);
+    nodes[node]->num_predecessors++;
+    validated = false;
+}
+
+void TaskGraph::run(ThreadPool& pool) {
+    if (nodes.empty()) return;
+    if (!validated) validate();
+
+    for (auto&& node : nodes) {
+        node->remaining.store(node->num_predecessors, std::memory_order_relaxed);
+    }
+
+    TaskGroup group{pool};
+    // Keep the first root for the calling thread.
+    for (size_t i = 1; i < roots.size(); ++i) {
+        schedule(group, roots[i]);
+    }
+    group.run_and_wait([this, &group] { run_node(group, roots[0]); });
+}
+
+size_t TaskGraph::size() const {
+    return nodes.size();
+}
+
+void TaskGraph::check(NodeId node) const {
+    if (node >= nodes.size()) {
+        std::stringstream s;
+        s << "Task graph node does not exist: " << node;
+        throw std::runtime_error{s.str()};
+    }
+}
+
+void TaskGraph::validate() {
+    // Kahn's algorithm: the graph is acyclic if and only if repeatedly removing nodes without
+    // predecessors removes every node.
+    std::vector<uint32_t> in_degree(nodes.size());
+    std::vector<NodeId> ready;
+    for (NodeId id = 0; id < nodes.size(); ++id) {
+        in_degree[id] = nodes[id]->num_predecessors;
+        if (in_degree[id] == 0) ready.push_back(id);
+    }
+
+    std::vector<NodeId> new_roots = ready;
+    size_t removed = 0;
+    while (!ready.empty()) {
+        NodeId id = ready.back();
+        ready.pop_back();
+        removed++;
+        for (NodeId successor : nodes[id]->successors) {
+            if (--in_degree[successor] == 0) ready.push_back(successor);
+        }
+    }
+
+    if (removed != nodes.size()) {
+        std::stringstream s;
+        s << "Task graph has a cycle through " << nodes.size() - removed << " nodes";
+        throw std::runtime_error{s.str()};
+    }
+
+    roots = std::move(new_roots);
+    validated = true;
+}
+
+void TaskGraph::schedule(TaskGroup& group, NodeId node) {
+    group.run([this, &group, node] { run_node(group, node); });
+}
+
+void TaskGraph::run_node(TaskGroup& group, NodeId id) {
+    constexpr NodeId none = static_cast<NodeId>(-1);
+
+    // A node that throws cancels the group, so the nodes that follow it on this thread are skipped.
+    while (id != none && !group.is_cancelled()) {
+        Node& node = *nodes[id];
+        if (node.task) node.task();
+
+        // Run the first successor that becomes ready on this thread, and let the others be stolen.
+        NodeId next = none;
+        for (NodeId successor : node.successors) {
+            if (nodes[successor]->remaining.fetch_sub(1, std::memory_order_acq_rel) != 1) continue;
+            if (next == none) {
+                next = successor;
+            } else {
+                schedule(group, successor);
+            }
+        }
+        id = next;
+    }
+}
+
+} // namespace spindle
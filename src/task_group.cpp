@@ -0,0 +1,66 @@
+#include "spindle/task_group.h"
+
+#include "event_count.h"
+
+namespace spindle {
+
+TaskGroup::TaskGroup(ThreadPool& pool) : pool(pool) {}
+
+TaskGroup::~TaskGroup() {
+    try {
+        wait();
+    } catch (...) {
+    }
+}
+
+void TaskGroup::wait() {
+    while (pending.load(std::memory_order_acquire) != 0) {
+        if (pool.try_run_one()) continue;
+        // Block until a task is queued or the last task of the group completes, both of which
+        // notify `helpers`. A task queued after the re-check is seen by `wait`.
+        EventCount::Key key = pool.helpers->prepare_wait();
+        if (pending.load(std::memory_order_acquire) == 0 || pool.try_run_one()) {
+            pool.helpers->cancel_wait();
+            continue;
+        }
+        pool.helpers->wait(key, clock::time_point::max());
+    }
+
+    // The thread that completed the last task may still hold `m`.
+    std::exception_ptr e;
+    {
+        std::lock_guard<std::mutex> lk{m};
+        e = std::move(error);
+        error = nullptr;
+        cancelled = false;
+    }
+    if (e) std::rethrow_exception(e);
+}
+
+void TaskGroup::cancel() {
+    cancelled = true;
+}
+
+bool TaskGroup::is_cancelled() const {
+    return cancelled.load(std::memory_order_relaxed);
+}
+
+void TaskGroup::complete() {
+    size_t n = pending.load(std::memory_order_relaxed);
+    while (n > 1) {
+        if (pending.compare_exchange_weak(n, n - 1, std::memory_order_acq_rel)) return;
+    }
+
+    // This may be the last task, so decrement under `m` to keep `wait` from returning before the
+    // waiting thread is notified.
+    std::lock_guard<std::mutex> lk{m};
+    if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) pool.helpers->notify();
+}
+
+void TaskGroup::fail(std::exception_ptr e) {
+    std::lock_guard<std::mutex> lk{m};
+    if (!error) error = std::move(e);
+    cancelled = true;
+}
+
+} // namespace spindle
@@ -0,0 +1,81 @@
+#include "thread.h"
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+namespace spindle {
+
+namespace {
+
+// Linux limits thread names to 16 bytes, including the terminator.
+constexpr size_t max_name_length = 15;
+
+void check(int err, const char* what) {
+    if (err == 0) return;
+    std::stringstream s;
+    s << "Failed to " << what << ": " << std::strerror(err);
+    throw std::runtime_error{s.str()};
+}
+
+} // namespace
+
+Thread::Thread(std::function<void()> body, const Attributes& attributes)
+    : body(std::move(body)), name(attributes.name.substr(0, max_name_length)) {
+    pthread_attr_t attr;
+    check(pthread_attr_init(&attr), "initialize thread attributes");
+    try {
+        if (attributes.stack_size != 0) {
+            check(pthread_attr_setstacksize(&attr, attributes.stack_size), "set thread stack size");
+        }
+#if defined(__linux__)
+        if (!attributes.cpus.empty()) {
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            for (uint32_t cpu : attributes.cpus) {
+                if (cpu >= CPU_SETSIZE) check(EINVAL, "pin thread to a CPU beyond CPU_SETSIZE");
+                CPU_SET(cpu, &cpus);
+            }
+            check(pthread_attr_setaffinity_np(&attr, sizeof(cpus), &cpus), "set thread affinity");
+        }
+#endif
+        check(pthread_create(&handle, &attr, &Thread::start, this), "create thread");
+    } catch (...) {
+        pthread_attr_destroy(&attr);
+        throw;
+    }
+    pthread_attr_destroy(&attr);
+}
+
+Thread::~Thread() {
+    if (joinable()) join();
+}
+
+bool Thread::joinable() const {
+    return !joined;
+}
+
+void Thread::join() {
+    check(pthread_join(handle, nullptr), "join thread");
+    joined = true;
+}
+
+void* Thread::start(void* arg) {
+    Thread* thread = static_cast<Thread*>(arg);
+    // Naming the thread is best effort, as it only helps debuggers and profilers.
+#if defined(__APPLE__)
+    pthread_setname_np(thread->name.c_str());
+#elif defined(__linux__)
+    pthread_setname_np(pthread_self(), thread->name.c_str());
+#endif
+    thread->body();
+    return nullptr;
+}
+
+} // namespace spindle
@@ -0,0 +1,48 @@
+#ifndef SPINDLE_THREAD_H_
+#define SPINDLE_THREAD_H_
+
+#include <pthread.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace spindle {
+
+// `Thread` is an operating system thread that, unlike `std::thread`, can be named, pinned to a set
+// of CPUs and given a stack size when it starts. A `Thread` is joined when it is destroyed.
+class Thread {
+  public:
+    struct Attributes {
+        std::string name;
+        // CPUs on which the thread may run, or empty to let it run anywhere.
+        std::vector<uint32_t> cpus;
+        // Stack size in bytes, or zero for the platform's default.
+        size_t stack_size;
+    };
+
+    // Starts a thread that runs `body`. Throws `std::runtime_error` if the thread cannot be
+    // started with the given attributes.
+    Thread(std::function<void()> body, const Attributes& attributes);
+    ~Thread();
+
+    Thread(const Thread&) = delete;
+    Thread& operator=(const Thread&) = delete;
+
+    bool joinable() const;
+    void join();
+
+  private:
+    std::function<void()> body;
+    std::string name;
+    pthread_t handle;
+    bool joined{false};
+
+    static void* start(void* arg);
+};
+
+} // namespace spindle
+
+#endif // SPINDLE_THREAD_H_
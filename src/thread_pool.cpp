@@ -1,24 +1,111 @@
 #include "spindle/thread_pool.h"
 
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <random>
 #include <sstream>
 #include <stdexcept>
+#include <string>
 
+#include "event_count.h"
+#include "scheduler.h"
+#include "thread.h"
+#include "topology.h"
+#include "trace.h"
 #include "worker.h"
 
 namespace spindle {
 
-ThreadPool::ThreadPool() : ThreadPool(std::thread::hardware_concurrency()) {}
+namespace {
 
-ThreadPool::ThreadPool(uint32_t num_threads) : next_worker(0) {
+// The pool and worker whose run loop is executing on the calling thread, if any.
+thread_local const ThreadPool* local_pool = nullptr;
+thread_local Worker* local_worker = nullptr;
+
+// Precision of the tasks that wait on the timer thread, which is finer than that of the workers
+// since the timer thread does nothing else.
+constexpr std::chrono::microseconds timer_resolution{100};
+
+// Returns a random number from a generator of the calling thread, so that threads submitting tasks
+// do not contend on it.
+uint32_t random_number() {
+    thread_local std::minstd_rand rng{static_cast<std::minstd_rand::result_type>(
+        std::hash<std::thread::id>{}(std::this_thread::get_id()))};
+    return rng();
+}
+
+ThreadPoolOptions with_threads(uint32_t num_threads) {
+    ThreadPoolOptions options;
+    options.num_threads = num_threads;
+    return options;
+}
+
+} // namespace
+
+ThreadPool::ThreadPool() : ThreadPool(ThreadPoolOptions{}) {}
+
+ThreadPool::ThreadPool(uint32_t num_threads) : ThreadPool(with_threads(num_threads)) {}
+
+ThreadPool::ThreadPool(const ThreadPoolOptions& options)
+    : options(options),
+      next_worker(0),
+      min_threads(std::min(options.min_threads, options.num_threads)),
+      num_running(0),
+      helpers(std::make_unique<EventCount>()) {
+    uint32_t num_threads = options.num_threads;
     if (num_threads <= 0) {
         std::stringstream s;
         s << "Thread pool thread count must be positive: " << num_threads;
         throw std::runtime_error{s.str()};
     }
-    for (int i = 0; i < num_threads; ++i) {
-        std::unique_ptr<Worker> worker = std::make_unique<Worker>();
+    if (options.cpu_affinity.size() > num_threads) {
+        std::stringstream s;
+        s << "Thread pool CPU affinity covers " << options.cpu_affinity.size()
+          << " threads, but the pool has " << num_threads;
+        throw std::runtime_error{s.str()};
+    }
+
+    std::vector<std::vector<uint32_t>> thread_cpus = options.cpu_affinity;
+    thread_cpus.resize(num_threads);
+    std::vector<int> thread_nodes(num_threads, 0);
+    bool pinned = options.numa_aware ||
+                  std::any_of(thread_cpus.begin(), thread_cpus.end(),
+                              [](const std::vector<uint32_t>& cpus) { return !cpus.empty(); });
+    if (pinned) place(options.numa_aware, thread_cpus, thread_nodes);
+    this->options.cpu_affinity = std::move(thread_cpus);
+
+    for (uint32_t i = 0; i < num_threads; ++i) {
+        std::unique_ptr<Worker> worker = std::make_unique<Worker>(std::chrono::milliseconds{1},
+                                                                  options.wait_strategy,
+                                                                  options.queue_capacity,
+                                                                  options.overflow_policy);
+        worker->enable_tracing(options.trace_capacity);
+        worker->wake_helpers(helpers.get());
         workers.push_back(std::move(worker));
-        worker_threads.emplace_back(&Worker::run, workers[i].get());
+    }
+    for (uint32_t i = 0; i < num_threads; ++i) {
+        for (uint32_t j = 0; j < num_threads; ++j) {
+            if (i != j) workers[i]->add_peer(workers[j].get(), thread_nodes[i] == thread_nodes[j]);
+        }
+    }
+
+    if (min_threads < num_threads) {
+        for (uint32_t i = 0; i < num_threads; ++i) {
+            workers[i]->on_backlog([this] { grow(); });
+            if (i < min_threads) continue;
+            workers[i]->retire_when_idle(options.idle_timeout, [this, i] { return retire(i); });
+            workers[i]->set_stopped(true);
+        }
+    }
+
+    worker_threads.resize(num_threads);
+    try {
+        grow_to(min_threads);
+    } catch (...) {
+        // Stop the threads that did start, since they are joined on the way out.
+        tear_down();
+        throw;
     }
 }
 
@@ -26,33 +113,387 @@ ThreadPool::~ThreadPool() {
     tear_down();
 }
 
-void ThreadPool::execute(const std::function<void()>& task) {
-    uint32_t idx = next_worker++ % workers.size(); // No harm in overflowing.
-    workers[idx]->schedule(task);
+void ThreadPool::execute(Task task, Priority priority) {
+    // Tasks spawned from within the pool stay on the spawning worker; idle peers steal them.
+    if (local_pool == this) {
+        local_worker->schedule(std::move(task), priority);
+        return;
+    }
+    uint32_t idx = next_external_worker();
+    workers[idx]->schedule(std::move(task), priority);
+    ensure_running(idx);
 }
 
-void ThreadPool::drain() {
+bool ThreadPool::try_execute(Task&& task, Priority priority) {
+    if (local_pool == this) return local_worker->try_schedule(task, priority);
+    uint32_t idx = next_external_worker();
+    bool scheduled = workers[idx]->try_schedule(task, priority);
+    ensure_running(idx);
+    return scheduled;
+}
+
+TaskHandle ThreadPool::execute_cancellable(Task task, Priority priority) {
+    auto cancel = detail::make_cancel_state();
+    execute(detail::cancellable(std::move(task), cancel), priority);
+    return TaskHandle{std::move(cancel)};
+}
+
+TaskHandle ThreadPool::execute_after(Task task, std::chrono::nanoseconds delay) {
+    if (local_pool == this) return local_worker->schedule(std::move(task), delay);
+    uint32_t idx = next_external_worker();
+    TaskHandle handle = workers[idx]->schedule(std::move(task), delay);
+    ensure_running(idx);
+    return handle;
+}
+
+void ThreadPool::execute_on(uint32_t worker_index, Task task) {
+    if (worker_index >= workers.size()) {
+        std::stringstream s;
+        s << "Thread pool worker index out of range: " << worker_index;
+        throw std::runtime_error{s.str()};
+    }
+    workers[worker_index]->schedule_pinned(std::move(task));
+    ensure_running(worker_index);
+}
+
+TaskHandle ThreadPool::schedule_after(Task task, std::chrono::nanoseconds delay) {
+    Scheduler* s = timer_thread();
+    if (s == nullptr) return {};
+    return s->schedule_after(std::move(task), delay);
+}
+
+TaskHandle ThreadPool::schedule_at_fixed_rate(Task task,
+                                              std::chrono::nanoseconds initial_delay,
+                                              std::chrono::nanoseconds period,
+                                              MissedRunPolicy policy) {
+    Scheduler* s = timer_thread();
+    if (s == nullptr) return {};
+    return s->schedule_periodic(std::move(task), initial_delay, period, true, policy);
+}
+
+TaskHandle ThreadPool::schedule_with_fixed_delay(Task task,
+                                                 std::chrono::nanoseconds initial_delay,
+                                                 std::chrono::nanoseconds delay) {
+    Scheduler* s = timer_thread();
+    if (s == nullptr) return {};
+    return s->schedule_periodic(
+        std::move(task), initial_delay, delay, false, MissedRunPolicy::catch_up);
+}
+
+Scheduler* ThreadPool::timer_thread() {
+    std::lock_guard<std::mutex> lk{threads_m};
+    if (scheduler == nullptr && !stopping) {
+        Thread::Attributes attributes{options.thread_name + "-timer", {}, options.stack_size};
+        scheduler = std::make_unique<Scheduler>(
+            timer_resolution, [this](Task task) { dispatch(std::move(task)); }, attributes);
+    }
+    return scheduler.get();
+}
+
+void ThreadPool::dispatch(Task task) {
+    uint32_t n = running_workers();
+    // Ties go to a different worker each time.
+    uint32_t start = next_worker++;
+    uint32_t idx = start % n;
+    size_t least = workers[idx]->load();
+    for (uint32_t i = 1; i < n && least > 0; ++i) {
+        uint32_t candidate = (start + i) % n;
+        size_t load = workers[candidate]->load();
+        if (load < least) {
+            idx = candidate;
+            least = load;
+        }
+    }
+    workers[idx]->schedule(std::move(task), Priority::normal);
+    ensure_running(idx);
+}
+
+uint32_t ThreadPool::next_external_worker() {
+    uint32_t n = running_workers();
+    if (!node_workers.empty()) {
+        int cpu = topology::current_cpu();
+        if (cpu >= 0 && static_cast<size_t>(cpu) < cpu_nodes.size() && cpu_nodes[cpu] >= 0) {
+            const std::vector<uint32_t>& local = node_workers[cpu_nodes[cpu]];
+            uint32_t idx = pick(local.size(), &local);
+            if (idx < n) return idx;
+        }
+    }
+    return pick(n);
+}
+
+uint32_t ThreadPool::pick(uint32_t n, const std::vector<uint32_t>* candidates) {
+    auto worker = [&](uint32_t i) { return candidates == nullptr ? i : (*candidates)[i]; };
+    // No harm in `next_worker` overflowing.
+    if (options.dispatch_policy == DispatchPolicy::round_robin || n == 1) {
+        return worker(next_worker++ % n);
+    }
+    uint32_t i = random_number() % n;
+    uint32_t a = worker(i);
+    uint32_t b = worker((i + 1 + random_number() % (n - 1)) % n);
+    return workers[b]->load() < workers[a]->load() ? b : a;
+}
+
+uint32_t ThreadPool::running_workers() {
+    if (num_running.load(std::memory_order_acquire) == 0) grow_to(1);
+    // Tasks still go to the first worker if no thread could be started.
+    return std::max(num_running.load(std::memory_order_acquire), 1u);
+}
+
+void ThreadPool::start(uint32_t idx) {
+    // The previous thread of the worker, if any, has retired.
+    if (worker_threads[idx]) worker_threads[idx]->join();
+    workers[idx]->set_stopped(false);
+
+    Thread::Attributes attributes{options.thread_name + "-" + std::to_string(idx),
+                                  options.cpu_affinity[idx],
+                                  options.stack_size};
+    try {
+        worker_threads[idx] = std::make_unique<Thread>(
+            [this, w = workers[idx].get()] {
+                local_pool = this;
+                local_worker = w;
+                w->run();
+            },
+            attributes);
+    } catch (...) {
+        worker_threads[idx] = nullptr;
+        if (idx >= min_threads) workers[idx]->set_stopped(true);
+        throw;
+    }
+}
+
+void ThreadPool::grow() {
+    if (num_running.load(std::memory_order_acquire) == workers.size()) return;
+    try {
+        // The running threads are counted under the lock: a thread that is still being started may
+        // already have looked for work before the task that calls for another thread was queued.
+        std::lock_guard<std::mutex> lk{threads_m};
+        if (!stopping) start_prefix(std::min<uint32_t>(num_running + 1, workers.size()));
+    } catch (const std::runtime_error&) {
+        // The running threads keep up as well as they can.
+    }
+}
+
+void ThreadPool::grow_to(uint32_t n) {
+    n = std::min<uint32_t>(n, workers.size());
+    if (num_running.load(std::memory_order_acquire) >= n) return;
+
+    std::lock_guard<std::mutex> lk{threads_m};
+    if (!stopping) start_prefix(n);
+}
+
+void ThreadPool::start_prefix(uint32_t n) {
+    for (uint32_t idx = num_running; idx < n; ++idx) {
+        start(idx);
+        num_running.store(idx + 1, std::memory_order_release);
+    }
+}
+
+void ThreadPool::ensure_running(uint32_t idx) {
+    if (!workers[idx]->is_stopped()) return;
+    // `num_running` is only accurate under the lock, as a retiring worker is marked as stopped
+    // before it is removed from the running ones.
+    std::lock_guard<std::mutex> lk{threads_m};
+    if (!stopping) start_prefix(idx + 1);
+}
+
+bool ThreadPool::retire(uint32_t idx) {
+    std::lock_guard<std::mutex> lk{threads_m};
+    // Only the most recently started thread retires, so that the running workers stay a prefix.
+    if (stopping || idx < min_threads || idx + 1 != num_running) return false;
+
+    // Pairs with `ensure_running`: either a producer observes the worker as stopped and starts it
+    // again, or the worker observes the task below.
+    Worker& worker = *workers[idx];
+    worker.set_stopped(true);
+    if (worker.has_queued_work()) {
+        worker.set_stopped(false);
+        return false;
+    }
+    num_running.store(idx, std::memory_order_release);
+    return true;
+}
+
+void ThreadPool::place(bool numa_aware,
+                       std::vector<std::vector<uint32_t>>& thread_cpus,
+                       std::vector<int>& thread_nodes) {
+    std::vector<std::vector<uint32_t>> nodes = topology::numa_nodes();
+    std::vector<int> node_of_cpu;
+    for (size_t node = 0; node < nodes.size(); ++node) {
+        for (uint32_t cpu : nodes[node]) {
+            if (cpu >= node_of_cpu.size()) node_of_cpu.resize(cpu + 1, -1);
+            node_of_cpu[cpu] = node;
+        }
+    }
+
+    // Threads are spread round-robin across nodes. A pinned thread counts as part of the node of
+    // its first CPU, and a thread that is not pinned as part of the first node.
+    std::vector<int> compact(nodes.size(), -1);
+    for (uint32_t i = 0; i < thread_cpus.size(); ++i) {
+        if (thread_cpus[i].empty() && numa_aware) thread_cpus[i] = nodes[i % nodes.size()];
+        int node = 0;
+        if (!thread_cpus[i].empty() && thread_cpus[i][0] < node_of_cpu.size()) {
+            node = std::max(node_of_cpu[thread_cpus[i][0]], 0);
+        }
+        thread_nodes[i] = node;
+        if (compact[node] < 0) {
+            compact[node] = node_workers.size();
+            node_workers.emplace_back();
+        }
+        node_workers[compact[node]].push_back(i);
+    }
+
+    // Locality only matters if the threads span several nodes.
+    if (node_workers.size() == 1) {
+        node_workers.clear();
+        return;
+    }
+    cpu_nodes.resize(node_of_cpu.size(), -1);
+    for (uint32_t cpu = 0; cpu < node_of_cpu.size(); ++cpu) {
+        if (node_of_cpu[cpu] >= 0) cpu_nodes[cpu] = compact[node_of_cpu[cpu]];
+    }
+}
+
+void ThreadPool::execute_bulk(Task* first, Task* last) {
+    size_t count = last - first;
+    size_t num_workers = running_workers();
+    size_t block_sz = count / num_workers;
+    size_t remainder = count % num_workers;
+
+    // Rotate the starting worker across batches so that the remainder does not always land on the
+    // same workers.
+    uint32_t start = next_worker++;
+    for (size_t i = 0; i < num_workers && first != last; ++i) {
+        size_t n = block_sz + (i < remainder ? 1 : 0);
+        uint32_t idx = (start + i) % num_workers;
+        workers[idx]->schedule_bulk(first, n);
+        ensure_running(idx);
+        first += n;
+    }
+}
+
+bool ThreadPool::try_run_one() {
+    Task task;
+    bool found = local_pool == this && local_worker->steal(task);
+    // Rotate the starting thread so that concurrent helpers do not all contend on the same queue.
+    uint32_t start = next_worker++;
+    for (size_t i = 0; !found && i < workers.size(); ++i) {
+        found = workers[(start + i) % workers.size()]->steal(task);
+    }
+    if (!found) return false;
+    task();
+    return true;
+}
+
+uint32_t ThreadPool::size() const {
+    return workers.size();
+}
+
+uint32_t ThreadPool::num_threads() const {
+    return num_running.load(std::memory_order_relaxed);
+}
+
+QueueingDelay ThreadPool::queueing_delay(Priority priority) const {
+    QueueingDelay delay{0, {}, {}};
     for (auto&& worker : workers) {
-        worker->drain();
+        QueueingDelay d = worker->queueing_delay(priority);
+        delay.tasks += d.tasks;
+        delay.total += d.total;
+        delay.max = std::max(delay.max, d.max);
     }
+    return delay;
+}
 
-    for (auto&& thread : worker_threads) {
-        if (thread.joinable()) {
-            thread.join();
+Metrics ThreadPool::metrics() const {
+    Metrics metrics{num_running.load(std::memory_order_relaxed), {}, workers[0]->capacity()};
+    for (auto&& worker : workers) {
+        metrics.workers.push_back(worker->metrics());
+    }
+    return metrics;
+}
+
+void ThreadPool::write_trace(std::ostream& out) const {
+    std::vector<std::vector<TraceEvent>> threads;
+    for (auto&& worker : workers) {
+        threads.push_back(worker->trace());
+    }
+    write_chrome_trace(out, threads, options.thread_name);
+}
+
+ThreadPool::ScheduleOperation ThreadPool::schedule() {
+    return {this};
+}
+
+ThreadPool::SleepOperation ThreadPool::sleep_for(std::chrono::nanoseconds delay) {
+    return {this, delay};
+}
+
+void detail::schedule(ThreadPool* pool, Task task) {
+    if (pool == nullptr) {
+        task();
+    } else {
+        pool->execute(std::move(task));
+    }
+}
+
+void ThreadPool::drain() {
+    Scheduler* s;
+    {
+        std::lock_guard<std::mutex> lk{threads_m};
+        stopping = true;
+        s = scheduler.get();
+    }
+    // Tasks that are not due yet are queued on the workers before they drain.
+    if (s != nullptr) s->drain();
+
+    {
+        std::lock_guard<std::mutex> lk{threads_m};
+        // Workers without a thread are drained right away, unless tasks were queued on them as
+        // their thread retired, in which case they are started to run them.
+        for (uint32_t idx = num_running; idx < workers.size(); ++idx) {
+            if (!workers[idx]->drain_stopped()) start_prefix(idx + 1);
         }
     }
+
+    for (auto&& worker : workers) {
+        worker->drain();
+    }
+
+    join();
 }
 
 void ThreadPool::tear_down() {
+    Scheduler* s;
+    {
+        std::lock_guard<std::mutex> lk{threads_m};
+        stopping = true;
+        s = scheduler.get();
+    }
+    if (s != nullptr) s->stop();
+
     for (auto&& worker : workers) {
         worker->terminate();
     }
 
+    join();
+}
+
+void ThreadPool::join() {
     for (auto&& thread : worker_threads) {
-        if (thread.joinable()) {
-            thread.join();
+        if (thread && thread->joinable()) {
+            thread->join();
         }
     }
 }
 
+ThreadPool& ThreadPool::default_pool() {
+    static ThreadPool pool{[] {
+        ThreadPoolOptions options;
+        options.num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+        options.min_threads = 0;
+        return options;
+    }()};
+    return pool;
+}
+
 } // namespace spindle
@@ -0,0 +1,215 @@
+#include "timer_wheel.h"
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+namespace spindle {
+
+namespace {
+
+uint32_t ctz(uint64_t x) {
+    return __builtin_ctzll(x);
+}
+
+uint32_t msb(uint64_t x) {
+    return 63 - __builtin_clzll(x);
+}
+
+} // namespace
+
+TimerWheel::TimerWheel(clock::duration resolution, clock::time_point origin)
+    : resolution(resolution), origin(origin) {
+    if (resolution <= clock::duration::zero()) {
+        std::stringstream s;
+        s << "Timer wheel resolution must be positive: " << resolution.count();
+        throw std::runtime_error{s.str()};
+    }
+}
+
+TimerWheel::~TimerWheel() {
+    for (auto&& level : slots) {
+        for (auto&& slot : level) {
+            release(slot);
+        }
+    }
+    release(overflow);
+    release(expired);
+    while (free_nodes != nullptr) {
+        Node* node = free_nodes;
+        free_nodes = node->next;
+        delete node;
+    }
+}
+
+void TimerWheel::insert(Timer timer) {
+    Node* node = free_nodes;
+    if (node != nullptr) {
+        free_nodes = node->next;
+        node->timer = std::move(timer);
+    } else {
+        node = new Node{std::move(timer), 0, nullptr};
+    }
+    node->tick = to_tick(node->timer.deadline, true);
+    count++;
+    place(node);
+}
+
+bool TimerWheel::poll(clock::time_point now, Timer& timer) {
+    uint64_t now_tick = to_tick(now, false);
+    while (expired.head == nullptr) {
+        Slot slot;
+        if (!next_slot(slot) || slot.tick > now_tick) {
+            // Nothing is due, so skip ahead to keep new timers in the lower levels. This preserves
+            // the placement of existing timers since none of their slots are passed over.
+            elapsed = std::max(elapsed, now_tick);
+            return false;
+        }
+
+        List list;
+        if (slot.level == num_levels) {
+            list = overflow;
+            overflow = {};
+        } else {
+            list = slots[slot.level][slot.idx];
+            slots[slot.level][slot.idx] = {};
+            occupied[slot.level] &= ~(uint64_t{1} << slot.idx);
+        }
+        elapsed = slot.tick;
+
+        while (Node* node = list.pop_front()) {
+            if (slot.level == 0) {
+                expired.push_back(node);
+            } else {
+                place(node); // Cascade into a lower level.
+            }
+        }
+    }
+
+    Node* node = expired.pop_front();
+    timer = std::move(node->timer);
+    node->next = free_nodes;
+    free_nodes = node;
+    count--;
+
+    return true;
+}
+
+clock::time_point TimerWheel::next_deadline() const {
+    if (expired.head != nullptr) return origin + resolution * static_cast<clock::rep>(elapsed);
+
+    Slot slot;
+    if (!next_slot(slot)) return clock::time_point::max();
+    return origin + resolution * static_cast<clock::rep>(slot.tick);
+}
+
+size_t TimerWheel::remove_if(const std::function<bool(const Timer&)>& pred) {
+    size_t removed = remove_if(overflow, pred) + remove_if(expired, pred);
+    for (uint32_t level = 0; level < num_levels; ++level) {
+        for (uint64_t bits = occupied[level]; bits != 0; bits &= bits - 1) {
+            uint32_t idx = ctz(bits);
+            removed += remove_if(slots[level][idx], pred);
+            if (slots[level][idx].head == nullptr) occupied[level] &= ~(uint64_t{1} << idx);
+        }
+    }
+    count -= removed;
+    return removed;
+}
+
+bool TimerWheel::empty() const {
+    return count == 0;
+}
+
+size_t TimerWheel::size() const {
+    return count;
+}
+
+uint64_t TimerWheel::to_tick(clock::time_point t, bool round_up) const {
+    if (t <= origin) return 0;
+    clock::duration d = t - origin;
+    if (round_up) d += resolution - clock::duration{1};
+    return d / resolution;
+}
+
+void TimerWheel::place(Node* node) {
+    // Timers that are already due go in the current slot of the lowest level. Timers beyond the
+    // current rotation of the top level wait in `overflow` until the next rotation begins.
+    uint64_t tick = std::max(node->tick, elapsed);
+    if (tick > (elapsed | (wheel_span - 1))) {
+        overflow.push_back(node);
+        return;
+    }
+
+    // The level is given by the most significant bit in which the tick differs from `elapsed`.
+    uint32_t level = msb((elapsed ^ tick) | (num_slots - 1)) / slot_bits;
+    uint32_t idx = (tick >> (level * slot_bits)) & (num_slots - 1);
+
+    slots[level][idx].push_back(node);
+    occupied[level] |= uint64_t{1} << idx;
+}
+
+bool TimerWheel::next_slot(Slot& slot) const {
+    // The earliest slot of a level precedes every slot of the levels above it, and no occupied slot
+    // precedes the current slot of its level.
+    for (uint32_t level = 0; level < num_levels; ++level) {
+        if (occupied[level] == 0) continue;
+
+        uint32_t shift = level * slot_bits;
+        uint32_t now_idx = (elapsed >> shift) & (num_slots - 1);
+        uint32_t idx = now_idx + ctz(occupied[level] >> now_idx);
+        uint64_t level_start = elapsed & ~((uint64_t{1} << (shift + slot_bits)) - 1);
+
+        slot = {level, idx, level_start + (uint64_t{idx} << shift)};
+        return true;
+    }
+
+    if (overflow.head != nullptr) {
+        slot = {num_levels, 0, (elapsed | (wheel_span - 1)) + 1};
+        return true;
+    }
+
+    return false;
+}
+
+size_t TimerWheel::remove_if(List& list, const std::function<bool(const Timer&)>& pred) {
+    size_t removed = 0;
+    List kept{};
+    while (Node* node = list.pop_front()) {
+        if (!pred(node->timer)) {
+            kept.push_back(node);
+            continue;
+        }
+        node->timer = {};
+        node->next = free_nodes;
+        free_nodes = node;
+        removed++;
+    }
+    list = kept;
+    return removed;
+}
+
+void TimerWheel::release(List& list) {
+    while (Node* node = list.pop_front()) {
+        delete node;
+    }
+}
+
+void TimerWheel::List::push_back(Node* node) {
+    node->next = nullptr;
+    if (tail == nullptr) {
+        head = node;
+    } else {
+        tail->next = node;
+    }
+    tail = node;
+}
+
+TimerWheel::Node* TimerWheel::List::pop_front() {
+    Node* node = head;
+    if (node == nullptr) return nullptr;
+    head = node->next;
+    if (head == nullptr) tail = nullptr;
+    return node;
+}
+
+} // namespace spindle
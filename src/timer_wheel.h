@@ -0,0 +1,112 @@
+#ifndef SPINDLE_TIMER_WHEEL_H_
+#define SPINDLE_TIMER_WHEEL_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+#include "spindle/task.h"
+#include "spindle/task_handle.h"
+
+namespace spindle {
+
+using clock = std::chrono::high_resolution_clock;
+
+// `Timer` is a task that is due at `deadline`. A periodic `Timer` is due again `delay` after each
+// time it fires. `cancel`, if set, is shared with the `TaskHandle` of the task.
+struct Timer {
+    Task func;
+    clock::time_point deadline;
+    clock::duration delay;
+    bool periodic;
+    std::shared_ptr<detail::CancelState> cancel{};
+};
+
+// `TimerWheel` is a hashed hierarchical timer wheel. Time is divided into ticks of a fixed
+// resolution, and each level of the wheel has 64 slots that each span 64 times as many ticks as a
+// slot of the level below. A `Timer` is hashed into the lowest level whose current rotation
+// contains its deadline, and is cascaded into lower levels as the wheel advances, so inserting and
+// expiring a `Timer` are constant-time operations. A `Timer` never fires before its deadline and
+// fires at most one tick late.
+class TimerWheel {
+  public:
+    // Creates a wheel whose ticks are `resolution` long, starting at `origin`.
+    TimerWheel(clock::duration resolution, clock::time_point origin = clock::now());
+    ~TimerWheel();
+
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    // Adds `timer` to the wheel.
+    void insert(Timer timer);
+    // Removes a `Timer` whose deadline has passed as of `now` and stores it in `timer`. Returns
+    // false if no `Timer` is due. Timers that are due at the same tick are returned in insertion
+    // order.
+    bool poll(clock::time_point now, Timer& timer);
+    // Returns the earliest point in time at which `poll` may return a `Timer`, or
+    // `clock::time_point::max()` if the wheel is empty.
+    clock::time_point next_deadline() const;
+    // Removes every `Timer` for which `pred` returns true, and returns how many were removed. Takes
+    // time linear in the number of timers.
+    size_t remove_if(const std::function<bool(const Timer&)>& pred);
+
+    bool empty() const;
+    size_t size() const;
+
+  private:
+    static constexpr uint32_t slot_bits = 6;
+    static constexpr uint32_t num_slots = 1 << slot_bits;
+    static constexpr uint32_t num_levels = 6;
+    // Number of ticks covered by a full rotation of the top level.
+    static constexpr uint64_t wheel_span = uint64_t{1} << (slot_bits * num_levels);
+
+    struct Node {
+        Timer timer;
+        uint64_t tick;
+        Node* next;
+    };
+
+    struct List {
+        Node* head;
+        Node* tail;
+
+        void push_back(Node* node);
+        Node* pop_front();
+    };
+
+    // A slot of the wheel, or `overflow` if `level` is `num_levels`.
+    struct Slot {
+        uint32_t level;
+        uint32_t idx;
+        uint64_t tick;
+    };
+
+    clock::duration resolution;
+    clock::time_point origin;
+    // The tick up to which the wheel has advanced.
+    uint64_t elapsed{};
+    size_t count{};
+    List slots[num_levels][num_slots]{};
+    // One bit per non-empty slot, for each level.
+    uint64_t occupied[num_levels]{};
+    // Timers beyond the current rotation of the top level.
+    List overflow{};
+    // Timers that have expired but have not been returned by `poll` yet.
+    List expired{};
+    // Recycled nodes, so that steady-state inserts do not allocate.
+    Node* free_nodes{};
+
+    uint64_t to_tick(clock::time_point t, bool round_up) const;
+    void place(Node* node);
+    bool next_slot(Slot& slot) const;
+    // Moves the timers of `list` that match `pred` to `free_nodes`, and returns how many there
+    // were.
+    size_t remove_if(List& list, const std::function<bool(const Timer&)>& pred);
+    static void release(List& list);
+};
+
+} // namespace spindle
+
+#endif // SPINDLE_TIMER_WHEEL_H_
@@ -0,0 +1,96 @@
+#include "topology.h"
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace spindle {
+
+namespace topology {
+
+namespace {
+
+const char* const node_dir = "/sys/devices/system/node/";
+
+[[noreturn]] void malformed(const std::string& list) {
+    std::stringstream s;
+    s << "Malformed CPU list: \"" << list << "\"";
+    throw std::runtime_error{s.str()};
+}
+
+uint32_t parse_cpu(const std::string& list, const std::string& cpu) {
+    // Nine digits cannot overflow.
+    if (cpu.empty() || cpu.size() > 9 || cpu.find_first_not_of("0123456789") != std::string::npos) {
+        malformed(list);
+    }
+    return std::stoul(cpu);
+}
+
+// Reads the first line of a file under `node_dir`, which is empty if the file cannot be read.
+std::string read_line(const std::string& name) {
+    std::ifstream file{node_dir + name};
+    std::string line;
+    std::getline(file, line);
+    return line;
+}
+
+} // namespace
+
+std::vector<uint32_t> parse_cpu_list(const std::string& list) {
+    std::vector<uint32_t> cpus;
+    std::stringstream s{list};
+    std::string range;
+    while (std::getline(s, range, ',')) {
+        size_t dash = range.find('-');
+        uint32_t first = parse_cpu(list, range.substr(0, dash));
+        uint32_t last = dash == std::string::npos ? first : parse_cpu(list, range.substr(dash + 1));
+        if (last < first) malformed(list);
+        for (uint32_t cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+std::vector<std::vector<uint32_t>> numa_nodes() {
+    std::vector<std::vector<uint32_t>> nodes;
+    try {
+        // Node numbers use the same format as CPU lists.
+        for (uint32_t node : parse_cpu_list(read_line("online"))) {
+            std::vector<uint32_t> cpus =
+                parse_cpu_list(read_line("node" + std::to_string(node) + "/cpulist"));
+            if (!cpus.empty()) nodes.push_back(std::move(cpus));
+        }
+    } catch (const std::runtime_error&) {
+        // Information that cannot be parsed is treated as missing.
+        nodes.clear();
+    }
+
+    if (nodes.empty()) {
+        uint32_t num_cpus = std::max(std::thread::hardware_concurrency(), 1u);
+        nodes.emplace_back();
+        for (uint32_t cpu = 0; cpu < num_cpus; ++cpu) {
+            nodes.back().push_back(cpu);
+        }
+    }
+    return nodes;
+}
+
+int current_cpu() {
+#if defined(__linux__)
+    return sched_getcpu();
+#else
+    return -1;
+#endif
+}
+
+} // namespace topology
+
+} // namespace spindle
@@ -0,0 +1,28 @@
+#ifndef SPINDLE_TOPOLOGY_H_
+#define SPINDLE_TOPOLOGY_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace spindle {
+
+namespace topology {
+
+// Parses a CPU list in the format used by sysfs, such as "0-3,8,10-11". Throws
+// `std::runtime_error` if `list` is malformed.
+std::vector<uint32_t> parse_cpu_list(const std::string& list);
+
+// Returns the CPUs of each NUMA node of the system, which are read from sysfs. Nodes without CPUs
+// are omitted. A system for which no NUMA information is available is reported as a single node
+// with every CPU.
+std::vector<std::vector<uint32_t>> numa_nodes();
+
+// Returns the CPU on which the calling thread is running, or -1 if it cannot be determined.
+int current_cpu();
+
+} // namespace topology
+
+} // namespace spindle
+
+#endif // SPINDLE_TOPOLOGY_H_
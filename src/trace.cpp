@@ -0,0 +1,112 @@
+#include "trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+
+namespace spindle {
+
+namespace {
+
+const char* const kind_names[] = {"critical", "normal", "background", "pinned", "deferred"};
+
+int64_t to_nanoseconds(clock::time_point t) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+}
+
+clock::time_point from_nanoseconds(int64_t ns) {
+    return clock::time_point{std::chrono::duration_cast<clock::duration>(
+        std::chrono::nanoseconds{ns})};
+}
+
+// Trace timestamps and durations are in microseconds, written with nanosecond precision without
+// going through floating point, which would round the timestamps of a system clock.
+void write_micros(std::ostream& out, std::chrono::nanoseconds value) {
+    int64_t ns = std::max<int64_t>(value.count(), 0);
+    char fill = out.fill('0');
+    out << ns / 1000 << "." << std::setw(3) << ns % 1000;
+    out.fill(fill);
+}
+
+void write_string(std::ostream& out, const std::string& s) {
+    out << '"';
+    for (char c : s) {
+        if (c == '"' || c == '\\') out << '\\';
+        out << c;
+    }
+    out << '"';
+}
+
+} // namespace
+
+TraceBuffer::TraceBuffer(size_t capacity)
+    : slots(capacity == 0 ? nullptr : new Slot[capacity + 1]()), capacity(capacity) {}
+
+void TraceBuffer::record(const TraceEvent& event) {
+    uint64_t h = head.load(std::memory_order_relaxed);
+    Slot& slot = slots[h % (capacity + 1)];
+    // Pairs with the fence in `snapshot`: a snapshot that reads any of the writes below also
+    // observes that `head` moved past the event that they overwrite.
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.queued.store(to_nanoseconds(event.queued), std::memory_order_relaxed);
+    slot.start.store(to_nanoseconds(event.start), std::memory_order_relaxed);
+    slot.end.store(to_nanoseconds(event.end), std::memory_order_relaxed);
+    slot.kind.store(static_cast<uint8_t>(event.kind), std::memory_order_relaxed);
+    slot.stolen.store(event.stolen, std::memory_order_relaxed);
+    head.store(h + 1, std::memory_order_release);
+}
+
+std::vector<TraceEvent> TraceBuffer::snapshot() const {
+    std::vector<TraceEvent> events;
+    if (!enabled()) return events;
+
+    uint64_t last = head.load(std::memory_order_acquire);
+    uint64_t first = last > capacity ? last - capacity : 0;
+    for (uint64_t i = first; i < last; ++i) {
+        const Slot& slot = slots[i % (capacity + 1)];
+        events.push_back({from_nanoseconds(slot.queued.load(std::memory_order_relaxed)),
+                          from_nanoseconds(slot.start.load(std::memory_order_relaxed)),
+                          from_nanoseconds(slot.end.load(std::memory_order_relaxed)),
+                          static_cast<TraceKind>(slot.kind.load(std::memory_order_relaxed)),
+                          slot.stolen.load(std::memory_order_relaxed)});
+    }
+
+    // Events whose slot was reused by the time they were read may be torn. Event `i` is
+    // overwritten by event `i + capacity + 1`, which is only recorded once `head` moved past
+    // `i + capacity`.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint64_t now = head.load(std::memory_order_relaxed);
+    if (now > first + capacity) {
+        size_t stale = std::min<uint64_t>(now - capacity - first, events.size());
+        events.erase(events.begin(), events.begin() + stale);
+    }
+    return events;
+}
+
+void write_chrome_trace(std::ostream& out,
+                        const std::vector<std::vector<TraceEvent>>& threads,
+                        const std::string& thread_name) {
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    const char* separator = "\n";
+    for (size_t tid = 0; tid < threads.size(); ++tid) {
+        out << separator << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << tid
+            << ",\"args\":{\"name\":";
+        write_string(out, thread_name + "-" + std::to_string(tid));
+        out << "}}";
+        separator = ",\n";
+
+        for (const TraceEvent& event : threads[tid]) {
+            out << separator << "{\"name\":\"" << kind_names[static_cast<size_t>(event.kind)]
+                << "\",\"cat\":\"task\",\"ph\":\"X\",\"pid\":1,\"tid\":" << tid << ",\"ts\":";
+            write_micros(out, event.start.time_since_epoch());
+            out << ",\"dur\":";
+            write_micros(out, event.end - event.start);
+            out << ",\"args\":{\"queued_us\":";
+            write_micros(out, event.start - event.queued);
+            out << ",\"stolen\":" << (event.stolen ? "true" : "false") << "}}";
+        }
+    }
+    out << "\n]}\n";
+}
+
+} // namespace spindle
@@ -0,0 +1,89 @@
+#ifndef SPINDLE_TRACE_H_
+#define SPINDLE_TRACE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "timer_wheel.h"
+
+// Set by the `SPINDLE_TRACING` build option, without which tasks are never traced.
+#ifndef SPINDLE_TRACING
+#define SPINDLE_TRACING 0
+#endif
+
+namespace spindle {
+
+// Where a traced task came from. The first classes match `Priority`.
+enum class TraceKind : uint8_t {
+    critical,
+    normal,
+    background,
+    pinned,
+    deferred,
+};
+
+// `TraceEvent` records a task that ran on a thread: when it was queued, or became due if it was
+// deferred, and when it started and ended.
+struct TraceEvent {
+    clock::time_point queued;
+    clock::time_point start;
+    clock::time_point end;
+    TraceKind kind;
+    // Whether the task was stolen from another thread's queue.
+    bool stolen;
+};
+
+// `TraceBuffer` keeps the most recent `TraceEvent`s of a single thread in a ring. The thread
+// records events without locks or read-modify-writes, and other threads may take a snapshot at any
+// time, which leaves out the events that are overwritten while it is taken.
+class TraceBuffer {
+  public:
+    // Creates a buffer of `capacity` events. A buffer without capacity records nothing.
+    explicit TraceBuffer(size_t capacity = 0);
+
+    TraceBuffer(const TraceBuffer&) = delete;
+    TraceBuffer& operator=(const TraceBuffer&) = delete;
+
+    bool enabled() const {
+        return capacity != 0;
+    }
+    // Records `event`, overwriting the oldest one if the buffer is full. Must only be called by
+    // the thread that owns the buffer.
+    void record(const TraceEvent& event);
+    // Returns the recorded events, oldest first.
+    std::vector<TraceEvent> snapshot() const;
+
+  private:
+    // Every field is atomic, so that a snapshot that races with `record` reads stale values
+    // rather than causing undefined behavior. Such values are discarded.
+    struct Slot {
+        std::atomic<int64_t> queued;
+        std::atomic<int64_t> start;
+        std::atomic<int64_t> end;
+        std::atomic<uint8_t> kind;
+        std::atomic_bool stolen;
+    };
+
+    // One slot more than `capacity`, so that the event being recorded never overwrites one that a
+    // snapshot may return.
+    std::unique_ptr<Slot[]> slots;
+    size_t capacity;
+    // Number of events recorded so far.
+    std::atomic<uint64_t> head{0};
+};
+
+// Writes the events of each thread in the Chrome trace event format, which Perfetto and
+// chrome://tracing open. Each thread is a track named `<thread_name>-<index>`, and each task a
+// slice named after its kind, with how long it was queued and whether it was stolen as arguments.
+void write_chrome_trace(std::ostream& out,
+                        const std::vector<std::vector<TraceEvent>>& threads,
+                        const std::string& thread_name);
+
+} // namespace spindle
+
+#endif // SPINDLE_TRACE_H_
@@ -1,52 +1,744 @@
 #include "worker.h"
 
+#include <algorithm>
+#include <thread>
+
 namespace spindle {
 
-Worker::Worker() : work{}, deadline{clock::time_point::max()} {}
+namespace {
+
+// Tells the processor that the calling thread is spinning, which saves power and frees resources
+// for a sibling hardware thread.
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    asm volatile("yield");
+#endif
+}
+
+// Adds `n` to a counter that only the calling thread writes, which takes no read-modify-write.
+inline void add(std::atomic<uint64_t>& counter, uint64_t n) {
+    counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+int64_t nanoseconds_since_epoch(clock::time_point t) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+}
+
+// Returns the size of an inbox that holds `capacity` tasks, or `unbounded` if `capacity` is zero.
+size_t inbox_size(size_t capacity, size_t unbounded) {
+    if (capacity == 0) return unbounded;
+    size_t size = 2;
+    while (size < capacity) {
+        size *= 2;
+    }
+    return size;
+}
+
+// The `Worker` whose run loop is executing on the calling thread, if any.
+thread_local const Worker* running_worker = nullptr;
+
+} // namespace
+
+constexpr uint32_t Worker::min_spins;
+constexpr uint32_t Worker::max_spins;
+
+Worker::Worker(clock::duration timer_resolution,
+               WaitStrategy wait_strategy,
+               size_t queue_capacity,
+               OverflowPolicy overflow_policy)
+    : queues{{inbox_size(queue_capacity, minor_inbox_capacity)},
+             {inbox_size(queue_capacity, inbox_capacity)},
+             {inbox_size(queue_capacity, minor_inbox_capacity)}},
+      queue_capacity{inbox_size(queue_capacity, 0)},
+      overflow_policy{overflow_policy},
+      blocking{queue_capacity != 0 && overflow_policy == OverflowPolicy::block},
+      timers{timer_resolution},
+      deadline{clock::time_point::max()},
+      rng{static_cast<std::minstd_rand::result_type>(reinterpret_cast<uintptr_t>(this))},
+      wait_strategy{wait_strategy} {}
 
 void Worker::run() {
-    for (;;) {
-        std::unique_lock<std::mutex> lk{m};
-
-        // Wait until:
-        // - Terminated
-        // - Drained
-        // - There is work due
-        // - `cv` times out
-
-        // Note: `cv` will never time out with the predicate evaluating to false. This is because
-        //       the deadline is set if and only if and only if work was scheduled.
-        cv.wait_until(lk, deadline, [this] {
-            bool drained = draining && work.empty();
-            bool work_due = !work.empty() && (clock::now() > work.top().deadline);
-            return terminated || drained || work_due;
-        });
+    const Worker* prev = running_worker;
+    running_worker = this;
+    enter(Phase::busy);
+    run_tasks();
+    enter(Phase::stopped);
+    running_worker = prev;
+}
 
+void Worker::run_tasks() {
+    Task func;
+    Timer timer;
+    for (;;) {
         if (terminated) return;
 
-        if (draining && work.empty()) {
-            drain_latch.decrement();
-            return;
+        // Immediate tasks are taken without the lock, unless a deferred or pinned task is pending.
+        if (!work_due() && !has_pinned && pop_inbox(func)) {
+            run_task(func);
+            continue;
+        }
+
+        {
+            std::unique_lock<std::mutex> lk{m};
+            if (terminated) return;
+
+            collect_tombstones();
+            if (pop_timer(timer)) {
+                lk.unlock();
+                share_backlog();
+                run_timer(timer);
+                continue;
+            }
+
+            if (pop(func)) {
+                lk.unlock();
+                run_task(func);
+                continue;
+            }
+
+            if (drained()) {
+                drain_latch.decrement();
+                return;
+            }
+        }
+
+        // A task stolen while waiting is run right away.
+        func = nullptr;
+        enter(Phase::idle);
+        if (wait_for_work(func)) return;
+        enter(Phase::busy);
+        woken = true;
+        if (func) {
+            add(counters.stolen, 1);
+            run_task(func);
+        }
+    }
+}
+
+void Worker::run_task(Task& func) {
+    share_backlog();
+    add(counters.executed, 1);
+#if SPINDLE_TRACING
+    if (tracer) {
+        clock::time_point start = clock::now();
+        func();
+        tracer->record({taken.queued, start, clock::now(), taken.kind, taken.stolen});
+        return;
+    }
+#endif
+    func();
+}
+
+void Worker::took(clock::time_point queued, TraceKind kind, bool stolen) {
+#if SPINDLE_TRACING
+    taken = {queued, kind, stolen};
+#else
+    static_cast<void>(queued);
+    static_cast<void>(kind);
+    static_cast<void>(stolen);
+#endif
+}
+
+void Worker::enter(Phase phase) {
+    int64_t now = nanoseconds_since_epoch(clock::now());
+    Phase current = counters.phase.load(std::memory_order_relaxed);
+    if (current != Phase::stopped) {
+        int64_t elapsed = now - counters.since.load(std::memory_order_relaxed);
+        add(current == Phase::busy ? counters.busy : counters.idle, std::max<int64_t>(elapsed, 0));
+    }
+    counters.since.store(now, std::memory_order_relaxed);
+    counters.phase.store(phase, std::memory_order_relaxed);
+}
+
+bool Worker::wait_for_work(Task& func) {
+    // Advertise idleness before looking for work: a producer either observes the flag and wakes
+    // this `Worker`, or the `Worker` observes the task below.
+    idle = true;
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (wait_strategy == WaitStrategy::spin) {
+        while (!has_work(func)) {
+            cpu_relax();
+        }
+        idle = false;
+        return false;
+    }
+
+    if (wait_strategy == WaitStrategy::adaptive) {
+        // Spinning that pays off is extended, and spinning that ends up blocking anyway is
+        // shortened, so the budget tracks how often work arrives shortly after running out.
+        for (uint32_t i = 0; i < spin_budget; ++i) {
+            if (has_work(func)) {
+                spin_budget = std::min(spin_budget * 2, max_spins);
+                idle = false;
+                return false;
+            }
+            cpu_relax();
+        }
+        for (uint32_t i = 0; i < num_yields; ++i) {
+            if (has_work(func)) {
+                idle = false;
+                return false;
+            }
+            std::this_thread::yield();
+        }
+        spin_budget = std::max(spin_budget / 2, min_spins);
+    }
+
+    clock::time_point wake_at = deadline.load();
+    clock::time_point retire_at = clock::time_point::max();
+    if (may_retire) {
+        retire_at = clock::now() + idle_timeout;
+        wake_at = std::min(wake_at, retire_at);
+    }
+
+    EventCount::Key key = events.prepare_wait();
+    bool found = has_work(func);
+    if (found) {
+        events.cancel_wait();
+    } else {
+        // Wakes up when:
+        // - A task is scheduled on this `Worker`
+        // - A producer hands this `Worker` a task to steal
+        // - Terminated or drained
+        // - The earliest deferred task is due
+        // - The idle timeout elapses
+        events.wait(key, wake_at);
+    }
+    // A producer that claimed the flag counts on this `Worker` to pick up its tasks, so it must
+    // not retire even if the idle timeout elapsed in the meantime.
+    bool poked = !idle.exchange(false);
+
+    return !found && !poked && retire_at != clock::time_point::max() &&
+           clock::now() >= retire_at && may_retire();
+}
+
+bool Worker::has_work(Task& func) {
+    if (terminated || !idle.load(std::memory_order_relaxed) || work_due() || has_pinned ||
+        !inboxes_empty()) {
+        return true;
+    }
+    // Whether the `Worker` is drained can only be decided under the lock, which is not worth taking
+    // while deferred tasks are pending.
+    if (draining && deadline.load(std::memory_order_relaxed) == clock::time_point::max()) {
+        return true;
+    }
+    return steal_from_peers(func);
+}
+
+void Worker::on_backlog(std::function<void()> handler) {
+    backlog_handler = std::move(handler);
+}
+
+void Worker::wake_helpers(EventCount* helpers) {
+    this->helpers = helpers;
+}
+
+void Worker::retire_when_idle(clock::duration timeout, std::function<bool()> handler) {
+    idle_timeout = timeout;
+    may_retire = std::move(handler);
+}
+
+void Worker::set_stopped(bool value) {
+    stopped.store(value, std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+bool Worker::is_stopped() const {
+    return stopped.load(std::memory_order_relaxed);
+}
+
+bool Worker::has_queued_work() {
+    std::lock_guard<std::mutex> lk{m};
+    if (producers != 0 || !inboxes_empty() || !pinned.empty() || !timers.empty()) return true;
+    for (const Queue& queue : queues) {
+        if (!queue.overflow.empty()) return true;
+    }
+    return false;
+}
+
+bool Worker::drain_stopped() {
+    std::lock_guard<std::mutex> lk{m};
+    draining = true;
+    return drained();
+}
+
+void Worker::add_peer(Worker* peer, bool near) {
+    if (near) {
+        peers.insert(peers.begin() + num_near_peers++, peer);
+    } else {
+        peers.push_back(peer);
+    }
+}
+
+bool Worker::steal(Task& func) {
+    Entry entry;
+    size_t cls;
+    if (!steal(entry, cls)) return false;
+    func = std::move(entry.func);
+    return true;
+}
+
+bool Worker::steal(Entry& entry, size_t& cls) {
+    if (terminated) return false;
+
+    for (cls = 0; cls < num_priorities; ++cls) {
+        Queue& queue = queues[cls];
+        if (queue.inbox.pop(entry)) {
+            dequeued();
+            made_room();
+            record(queue, entry.queued);
+            return true;
+        }
+    }
+
+    for (cls = 0; cls < num_priorities; ++cls) {
+        Queue& queue = queues[cls];
+        if (!queue.overflowing.load(std::memory_order_relaxed)) continue;
+        std::lock_guard<std::mutex> lk{m};
+        if (queue.overflow.empty()) continue;
+        entry = std::move(queue.overflow.back());
+        dequeued();
+        record(queue, entry.queued);
+        queue.overflow.pop_back();
+        queue.overflowing = !queue.overflow.empty();
+        return true;
+    }
+    return false;
+}
+
+QueueingDelay Worker::queueing_delay(Priority priority) const {
+    const Queue& queue = queues[static_cast<size_t>(priority)];
+    return {queue.tasks.load(std::memory_order_relaxed),
+            std::chrono::nanoseconds{queue.total_delay.load(std::memory_order_relaxed)},
+            std::chrono::nanoseconds{queue.max_delay.load(std::memory_order_relaxed)}};
+}
+
+WorkerMetrics Worker::metrics() {
+    WorkerMetrics metrics{};
+    {
+        std::lock_guard<std::mutex> lk{m};
+        metrics.queued = pinned.size();
+        for (size_t p = 0; p < num_priorities; ++p) {
+            metrics.queue_depth[p] = queues[p].overflow.size();
+        }
+        metrics.deferred = timers.size();
+    }
+    for (size_t p = 0; p < num_priorities; ++p) {
+        const Queue& queue = queues[p];
+        metrics.queue_depth[p] += queue.inbox.size();
+        metrics.queued += metrics.queue_depth[p];
+        Histogram& delay = metrics.queueing_delay[p];
+        for (size_t b = 0; b < Histogram::num_buckets; ++b) {
+            delay.counts[b] = queue.delays[b].load(std::memory_order_relaxed);
+        }
+        delay.sum = std::chrono::nanoseconds{queue.total_delay.load(std::memory_order_relaxed)};
+    }
+
+    metrics.executed = counters.executed.load(std::memory_order_relaxed);
+    metrics.stolen = counters.stolen.load(std::memory_order_relaxed);
+    metrics.overflowed = overflow_counters.overflowed.load(std::memory_order_relaxed);
+    metrics.dropped = overflow_counters.dropped.load(std::memory_order_relaxed);
+    metrics.busy_time = std::chrono::nanoseconds{counters.busy.load(std::memory_order_relaxed)};
+    metrics.idle_time = std::chrono::nanoseconds{counters.idle.load(std::memory_order_relaxed)};
+    // The current phase is only accounted for once it ends.
+    Phase phase = counters.phase.load(std::memory_order_relaxed);
+    if (phase != Phase::stopped) {
+        std::chrono::nanoseconds elapsed{std::max<int64_t>(
+            nanoseconds_since_epoch(clock::now()) - counters.since.load(std::memory_order_relaxed),
+            0)};
+        (phase == Phase::busy ? metrics.busy_time : metrics.idle_time) += elapsed;
+    }
+    return metrics;
+}
+
+size_t Worker::capacity() const {
+    return queue_capacity;
+}
+
+size_t Worker::load() const {
+    size_t n = depth.tasks.load(std::memory_order_relaxed);
+    return idle.load(std::memory_order_relaxed) ? n : n + 1;
+}
+
+void Worker::enable_tracing(size_t capacity) {
+#if SPINDLE_TRACING
+    tracer.reset(capacity == 0 ? nullptr : new TraceBuffer{capacity});
+#else
+    static_cast<void>(capacity);
+#endif
+}
+
+std::vector<TraceEvent> Worker::trace() const {
+    return tracer ? tracer->snapshot() : std::vector<TraceEvent>{};
+}
+
+bool Worker::pop_timer(Timer& timer) {
+    // Deferred tasks that are due have been waiting the longest, so they go before immediate ones.
+    if (!work_due()) return false;
+    bool due;
+    do {
+        due = timers.poll(clock::now(), timer);
+    } while (due && !claim(timer));
+    deadline = timers.next_deadline();
+    return due;
+}
+
+bool Worker::claim(Timer& timer) {
+    if (timer.cancel == nullptr) return true;
+    if (timer.periodic ? !timer.cancel->cancelled() : timer.cancel->start()) return true;
+    tombstones->fetch_sub(1, std::memory_order_relaxed);
+    return false;
+}
+
+void Worker::collect_tombstones() {
+    int64_t n = tombstones->load(std::memory_order_relaxed);
+    bool dominant = n >= min_tombstones && static_cast<uint64_t>(n) * 2 >= timers.size();
+    // A draining `Worker` does not wait for cancelled tasks to come up.
+    if (!dominant && !(draining && n > 0)) return;
+    size_t removed = timers.remove_if(
+        [](const Timer& timer) { return timer.cancel != nullptr && timer.cancel->cancelled(); });
+    tombstones->fetch_sub(removed, std::memory_order_relaxed);
+    deadline = timers.next_deadline();
+}
+
+void Worker::run_timer(Timer& timer) {
+    add(counters.executed, 1);
+#if SPINDLE_TRACING
+    if (tracer) {
+        clock::time_point start = clock::now();
+        timer.func();
+        tracer->record({timer.deadline, start, clock::now(), TraceKind::deferred, false});
+    } else {
+        timer.func();
+    }
+#else
+    timer.func();
+#endif
+    if (!timer.periodic || !claim(timer)) return;
+
+    // The task is rescheduled relative to its previous deadline so that periods do not drift.
+    timer.deadline += timer.delay;
+    std::lock_guard<std::mutex> lk{m};
+    do_schedule(std::move(timer));
+}
+
+bool Worker::pop(Task& func) {
+    // Pinned tasks go first, as they are only taken under the lock.
+    if (!pinned.empty()) {
+        took(pinned.front().queued, TraceKind::pinned, false);
+        func = std::move(pinned.front().func);
+        pinned.pop_front();
+        dequeued();
+        has_pinned = !pinned.empty();
+        return true;
+    }
+    if (pop_inbox(func)) return true;
+    for (size_t i = 0; i < num_priorities; ++i) {
+        size_t cls = class_to_serve(i);
+        Queue& queue = queues[cls];
+        if (queue.overflow.empty()) continue;
+        record(queue, queue.overflow.front().queued);
+        took(queue.overflow.front().queued, static_cast<TraceKind>(cls), false);
+        func = std::move(queue.overflow.front().func);
+        queue.overflow.pop_front();
+        dequeued();
+        queue.overflowing = !queue.overflow.empty();
+        turn++;
+        return true;
+    }
+    return false;
+}
+
+bool Worker::pop_inbox(Task& func) {
+    Entry entry;
+    for (size_t i = 0; i < num_priorities; ++i) {
+        size_t cls = class_to_serve(i);
+        Queue& queue = queues[cls];
+        if (queue.inbox.pop(entry)) {
+            dequeued();
+            made_room();
+            record(queue, entry.queued);
+            took(entry.queued, static_cast<TraceKind>(cls), false);
+            func = std::move(entry.func);
+            turn++;
+            return true;
         }
+    }
+    return false;
+}
+
+size_t Worker::class_to_serve(size_t i) const {
+    // Out of every 16 turns, the last goes to background tasks, three more go to normal ones, and
+    // the rest go to critical ones. A class without tasks passes its turn on to the others, in
+    // order of priority.
+    uint32_t t = turn % 16;
+    Priority priority = Priority::critical;
+    if (t == 15) {
+        priority = Priority::background;
+    } else if (t % 4 == 3) {
+        priority = Priority::normal;
+    }
+    size_t first = static_cast<size_t>(priority);
+    if (i == 0) return first;
+    return i - 1 < first ? i - 1 : i;
+}
 
-        Task task = work.top();
-        work.pop();
-        deadline = work.empty() ? clock::time_point::max() : work.top().deadline;
-        if (task.periodic) {
-            task.deadline += task.delay;
-            do_schedule(task);
+bool Worker::inboxes_empty() const {
+    for (const Queue& queue : queues) {
+        if (!queue.inbox.empty()) return false;
+    }
+    return true;
+}
+
+void Worker::record(Queue& queue, clock::time_point queued) {
+    uint64_t delay = std::max<int64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - queued).count(), 0);
+    queue.tasks.fetch_add(1, std::memory_order_relaxed);
+    queue.total_delay.fetch_add(delay, std::memory_order_relaxed);
+    uint64_t max = queue.max_delay.load(std::memory_order_relaxed);
+    while (delay > max &&
+           !queue.max_delay.compare_exchange_weak(max, delay, std::memory_order_relaxed)) {
+    }
+    queue.delays[Histogram::bucket(std::chrono::nanoseconds{delay})].fetch_add(
+        1, std::memory_order_relaxed);
+}
+
+bool Worker::work_due() const {
+    clock::time_point d = deadline.load(std::memory_order_relaxed);
+    return d != clock::time_point::max() && clock::now() > d;
+}
+
+bool Worker::drained() const {
+    if (!draining || producers != 0 || !inboxes_empty() || !pinned.empty() || !timers.empty()) {
+        return false;
+    }
+    for (const Queue& queue : queues) {
+        if (!queue.overflow.empty()) return false;
+    }
+    return true;
+}
+
+bool Worker::steal_from_peers(Task& func) {
+    return steal_from(0, num_near_peers, func) || steal_from(num_near_peers, peers.size(), func);
+}
+
+bool Worker::steal_from(size_t first, size_t last, Task& func) {
+    size_t n = last - first;
+    if (n == 0) return false;
+    size_t start = rng() % n;
+    Entry entry;
+    size_t cls;
+    for (size_t i = 0; i < n; ++i) {
+        if (!peers[first + (start + i) % n]->steal(entry, cls)) continue;
+        took(entry.queued, static_cast<TraceKind>(cls), true);
+        func = std::move(entry.func);
+        return true;
+    }
+    return false;
+}
+
+void Worker::share_backlog() {
+    // Tasks queued while a `Worker` was idle, or while it was busy and no peer was idle, did not
+    // wake anybody else, so hand the rest of them to an idle peer, or ask for another thread if
+    // there is none. A `Worker` woken up for a task queued on a peer may take a different one, so
+    // the first task it takes after waking up checks the queues of every peer.
+    bool backlog = !inboxes_empty();
+    if (woken) {
+        woken = false;
+        for (size_t i = 0; i < peers.size() && !backlog; ++i) {
+            backlog = !peers[i]->inboxes_empty();
         }
+    }
+    if (!backlog || poke_peer()) return;
+    if (backlog_handler) backlog_handler();
+}
 
-        lk.unlock();
-        task.func();
+bool Worker::poke_peer() {
+    return poke(0, num_near_peers) || poke(num_near_peers, peers.size());
+}
+
+bool Worker::poke(size_t first, size_t last) {
+    size_t n = last - first;
+    if (n == 0) return false;
+    size_t start = next_peer++ % n;
+    for (size_t i = 0; i < n; ++i) {
+        Worker* peer = peers[first + (start + i) % n];
+        // Claim the peer so that concurrent producers poke different ones. Busy peers are skipped
+        // without writing to their cache line.
+        if (peer->idle.load(std::memory_order_relaxed) && peer->idle.exchange(false)) {
+            peer->events.notify();
+            return true;
+        }
     }
+    return false;
 }
 
-bool Worker::do_schedule(const Task& task) {
+bool Worker::schedule(Task func, Priority priority) {
+    return schedule_now(std::move(func), priority);
+}
+
+TaskHandle Worker::schedule_cancellable(Task func, Priority priority) {
+    auto cancel = detail::make_cancel_state();
+    if (!schedule_now(detail::cancellable(std::move(func), cancel), priority)) return {};
+    return TaskHandle{std::move(cancel)};
+}
+
+bool Worker::try_schedule(Task& func, Priority priority) {
+    Entry entry{std::move(func), clock::now()};
+    if (push(queues[static_cast<size_t>(priority)], entry) == Push::queued) return true;
+    func = std::move(entry.func);
+    return false;
+}
+
+bool Worker::schedule_now(Task func, Priority priority) {
+    Queue& queue = queues[static_cast<size_t>(priority)];
+    Entry entry{std::move(func), clock::now()};
+    Push result = push(queue, entry);
+    if (result == Push::full) return overflow(queue, entry);
+    return result == Push::queued;
+}
+
+Worker::Push Worker::push(Queue& queue, Entry& entry) {
+    producers++;
+    depth.tasks.fetch_add(1, std::memory_order_relaxed);
+    Push result = terminated || draining ? Push::rejected : Push::queued;
+    if (result == Push::queued && !queue.inbox.push(std::move(entry))) {
+        if (queue_capacity != 0) {
+            result = Push::full;
+        } else {
+            std::lock_guard<std::mutex> lk{m};
+            if (terminated || draining) {
+                result = Push::rejected;
+            } else {
+                queue.overflow.push_back(std::move(entry));
+                queue.overflowing = true;
+            }
+        }
+    }
+    if (result != Push::queued) depth.tasks.fetch_sub(1, std::memory_order_relaxed);
+    producers--;
+
+    // Pairs with the fence in `wait_for_work`: either this thread observes the `Worker` as idle,
+    // or the `Worker` observes the task. An idle `Worker` that is still spinning needs no wakeup,
+    // which `notify` detects.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (helpers != nullptr && result == Push::queued) helpers->notify_fenced();
+    if (idle) {
+        events.notify();
+    } else if (result == Push::queued && !poke_peer() && backlog_handler) {
+        // This `Worker` is busy and no peer is idle to steal the task.
+        backlog_handler();
+    }
+
+    return result;
+}
+
+bool Worker::overflow(Queue& queue, Entry& entry) {
+    overflow_counters.overflowed.fetch_add(1, std::memory_order_relaxed);
+    switch (overflow_policy) {
+    case OverflowPolicy::block:
+        // The thread of this `Worker` would wait on itself.
+        if (running_worker == this) break;
+        for (;;) {
+            EventCount::Key key = room.prepare_wait();
+            Push result = push(queue, entry);
+            if (result != Push::full) {
+                room.cancel_wait();
+                return result == Push::queued;
+            }
+            room.wait(key, clock::time_point::max());
+        }
+    case OverflowPolicy::caller_runs:
+        break;
+    case OverflowPolicy::drop_oldest:
+        for (;;) {
+            Entry oldest;
+            if (queue.inbox.pop(oldest)) {
+                dequeued();
+                overflow_counters.dropped.fetch_add(1, std::memory_order_relaxed);
+            }
+            Push result = push(queue, entry);
+            if (result != Push::full) return result == Push::queued;
+        }
+    }
+    entry.func();
+    return true;
+}
+
+void Worker::made_room() {
+    if (blocking) room.notify();
+}
+
+void Worker::dequeued() {
+    depth.tasks.fetch_sub(1, std::memory_order_relaxed);
+}
+
+size_t Worker::schedule_bulk(Task* tasks, size_t count) {
+    // Moves the tasks into entries as they are pushed, which share the time the batch was queued.
+    struct Stamped {
+        Task* tasks;
+        clock::time_point queued;
+
+        Entry operator[](size_t i) const {
+            return {std::move(tasks[i]), queued};
+        }
+    };
+
+    Queue& queue = queues[static_cast<size_t>(Priority::normal)];
+    Stamped stamped{tasks, clock::now()};
+    producers++;
+    size_t scheduled = 0;
+    bool accepted = !terminated && !draining;
+    if (accepted) {
+        depth.tasks.fetch_add(count, std::memory_order_relaxed);
+        scheduled = queue.inbox.push_bulk(stamped, count);
+        if (scheduled < count && queue_capacity == 0) {
+            std::lock_guard<std::mutex> lk{m};
+            if (!terminated && !draining) {
+                for (; scheduled < count; ++scheduled) {
+                    queue.overflow.push_back(stamped[scheduled]);
+                }
+                queue.overflowing = true;
+            }
+        }
+        // The rest is pushed one by one below, if at all.
+        if (scheduled < count) depth.tasks.fetch_sub(count - scheduled, std::memory_order_relaxed);
+    }
+    producers--;
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (helpers != nullptr && scheduled > 0) helpers->notify_fenced();
+    if (idle) events.notify();
+
+    // The rest of a batch that fills a bounded inbox is subject to the overflow policy.
+    while (accepted && scheduled < count &&
+           schedule_now(std::move(tasks[scheduled]), Priority::normal)) {
+        scheduled++;
+    }
+    return scheduled;
+}
+
+bool Worker::schedule_pinned(Task func) {
+    {
+        std::lock_guard<std::mutex> lk{m};
+        if (terminated || draining) return false;
+        pinned.push_back({std::move(func), clock::now()});
+        depth.tasks.fetch_add(1, std::memory_order_relaxed);
+        has_pinned = true;
+    }
+    events.notify();
+    return true;
+}
+
+bool Worker::do_schedule(Timer timer) {
     if (terminated || draining) return false;
 
-    work.push(task);
-    deadline = std::min(deadline, work.top().deadline);
+    timers.insert(std::move(timer));
+    deadline = timers.next_deadline();
+    collect_tombstones();
 
     return true;
 }
@@ -56,26 +748,20 @@ void Worker::drain() {
         std::lock_guard<std::mutex> lk{m};
         if (draining) return;
         draining = true;
-        cv.notify_one();
     }
+    events.notify();
+    room.notify();
     drain_latch.wait();
 }
 
 void Worker::terminate() {
-    std::lock_guard<std::mutex> lk{m};
-    if (terminated) return;
-    terminated = true;
-    cv.notify_one();
-}
-
-Task::Task(std::function<void()> func,
-           clock::duration delay,
-           bool periodic,
-           clock::time_point deadline)
-    : func(std::move(func)), delay(delay), periodic(periodic), deadline(deadline) {}
-
-bool Task::operator>(const Task& other) const {
-    return deadline > other.deadline;
+    {
+        std::lock_guard<std::mutex> lk{m};
+        if (terminated) return;
+        terminated = true;
+    }
+    events.notify();
+    room.notify();
 }
 
 } // namespace spindle
@@ -1,48 +1,94 @@
 #ifndef SPINDLE_WORKER_H_
 #define SPINDLE_WORKER_H_
 
+#include <atomic>
 #include <chrono>
-#include <condition_variable>
+#include <cstdint>
+#include <deque>
 #include <functional>
+#include <memory>
 #include <mutex>
-#include <queue>
+#include <random>
+#include <vector>
 
 #include "spindle/latch.h"
+#include "spindle/metrics.h"
+#include "spindle/overflow_policy.h"
+#include "spindle/priority.h"
+#include "spindle/slab.h"
+#include "spindle/task.h"
+#include "spindle/task_handle.h"
+#include "spindle/wait_strategy.h"
 
-namespace spindle {
-
-using clock = std::chrono::high_resolution_clock;
-
-class Worker;
-
-class Task {
-  public:
-    Task(std::function<void()> func,
-         clock::duration delay,
-         bool periodic,
-         clock::time_point deadline);
-
-    // Sort in ascending order of execution time.
-    bool operator>(const Task& other) const;
-
-    friend Worker;
+#include "event_count.h"
+#include "mpmc_queue.h"
+#include "timer_wheel.h"
+#include "trace.h"
 
-  private:
-    std::function<void()> func;
-    clock::time_point deadline;
-    clock::duration delay;
-    bool periodic;
-};
+namespace spindle {
 
-// `Worker` continuously executes tasks in a loop, until terminated.
+// `Worker` continuously executes tasks in a loop, until terminated. Immediate tasks are pushed to a
+// lock-free inbox per `Priority`, which the `Worker` drains without taking its lock and from which
+// idle peers steal. Deferred and periodic tasks are kept in a timer wheel guarded by a mutex, and
+// are never stolen. An idle `Worker` waits for work according to its `WaitStrategy`, and blocks on
+// an `EventCount`, so producers only make a system call if the `Worker` is actually blocked. The
+// inboxes spill over into a list under the lock, unless they are bounded, in which case a task that
+// finds its inbox full is dealt with according to an `OverflowPolicy`.
 class Worker {
   public:
-    Worker();
+    // Creates a `Worker` whose deferred tasks fire with the given precision. If `queue_capacity` is
+    // not zero, each inbox holds that many immediate tasks, rounded up to a power of two, and
+    // `overflow_policy` applies once it is full.
+    explicit Worker(clock::duration timer_resolution = std::chrono::milliseconds{1},
+                    WaitStrategy wait_strategy = WaitStrategy::adaptive,
+                    size_t queue_capacity = 0,
+                    OverflowPolicy overflow_policy = OverflowPolicy::block);
     // Continuously executes enqueued tasks until terminated.
     void run();
-    // Schedules a task for execution.
-    template <class T = clock::duration>
-    bool schedule(const std::function<void()>& func, T delay = {}, bool periodic = false);
+    // Schedules a task for execution once `delay` has elapsed, and then every `delay` if
+    // `periodic` is set. Returns a handle that cancels the task, which refers to no task if it was
+    // rejected.
+    template <class T>
+    TaskHandle schedule(Task func, T delay, bool periodic = false);
+    // Schedules an immediate task of the given priority for execution. Unlike the overloads that
+    // return a handle, this does not allocate.
+    bool schedule(Task func, Priority priority = Priority::normal);
+    // Schedules an immediate task like `schedule`, and returns a handle that cancels it until it
+    // starts, which refers to no task if it was rejected.
+    TaskHandle schedule_cancellable(Task func, Priority priority = Priority::normal);
+    // Schedules an immediate task like `schedule`, unless its inbox is bounded and full. Returns
+    // false, leaving `func` untouched, if the task was not queued.
+    bool try_schedule(Task& func, Priority priority);
+    // Schedules the `count` normal immediate tasks at `tasks` for execution, moving from them. The
+    // lock is taken at most once and the `Worker` is woken at most once. Returns the number of
+    // tasks that were scheduled, which is either zero or `count`.
+    size_t schedule_bulk(Task* tasks, size_t count);
+    // Schedules an immediate task that only this `Worker` runs, as opposed to tasks scheduled with
+    // `schedule`, which idle peers may steal.
+    bool schedule_pinned(Task func);
+    // Adds `peer` to the set of workers from which this `Worker` steals immediate tasks when it
+    // runs out of work. Near peers, such as those on the same NUMA node, are tried before the
+    // others. Must be called before `run`.
+    void add_peer(Worker* peer, bool near = true);
+    // Removes an immediate task from this `Worker`'s queue and stores it in `func`. Returns false
+    // if there is nothing to steal. Tasks of higher priority are stolen first.
+    bool steal(Task& func);
+    // Returns how long the immediate tasks of the given priority taken from this `Worker` so far
+    // have been queued.
+    QueueingDelay queueing_delay(Priority priority) const;
+    // Returns a snapshot of the activity of this `Worker`.
+    WorkerMetrics metrics();
+    // Returns an estimate of how busy this `Worker` is, without taking its lock: the number of
+    // immediate tasks queued on it, pinned or spilled over included, plus one unless it is idle.
+    size_t load() const;
+    // Returns the number of immediate tasks of each priority the `Worker` can queue, or zero if
+    // there is no limit.
+    size_t capacity() const;
+    // Records the last `capacity` tasks that run on this `Worker`, or none if `capacity` is zero.
+    // Does nothing unless the library is built with `SPINDLE_TRACING`. Must be called before `run`.
+    void enable_tracing(size_t capacity);
+    // Returns the recorded tasks, oldest first.
+    std::vector<TraceEvent> trace() const;
     // Drains the `Worker`. From this point onwards, the `Worker` will reject new tasks but will
     // continue executing the inflight task and the any tasks remaining in the work queue.
     void drain();
@@ -50,28 +96,229 @@ class Worker {
     // continue executing any inflight task.
     void terminate();
 
+    // Calls `handler` whenever an immediate task is queued while this `Worker` is busy and no peer
+    // is idle. Must be called before `run`.
+    void on_backlog(std::function<void()> handler);
+    // Notifies `helpers` whenever an immediate task that peers can steal is queued. Must be called
+    // before `run`.
+    void wake_helpers(EventCount* helpers);
+    // Makes `run` return once the `Worker` has been idle for `timeout` and `handler` returns true.
+    // Must be called before `run`.
+    void retire_when_idle(clock::duration timeout, std::function<bool()> handler);
+    // Marks whether the run loop of the `Worker` is stopped, so that producers know to start it.
+    // Acts as a full fence.
+    void set_stopped(bool value);
+    bool is_stopped() const;
+    // Returns true if the `Worker` holds tasks of any kind, or a task is being queued.
+    bool has_queued_work();
+    // Drains a `Worker` whose run loop is stopped, without waiting for it. Returns false if tasks
+    // are still queued, in which case the run loop must be started to run them.
+    bool drain_stopped();
+
   private:
-    std::priority_queue<Task, std::vector<Task>, std::greater<>> work{};
+    static constexpr size_t inbox_capacity = 1024;
+    // Critical and background tasks are expected to be less common, so their inboxes are smaller.
+    static constexpr size_t minor_inbox_capacity = 256;
+    // Bounds of the number of spins of the adaptive wait strategy before it yields.
+    static constexpr uint32_t min_spins = 16;
+    static constexpr uint32_t max_spins = 4096;
+    // Number of times the adaptive wait strategy yields before it blocks.
+    static constexpr uint32_t num_yields = 8;
+    // Cancelled deferred tasks are left in the timer wheel until they come up, unless there are at
+    // least this many and they make up half of the wheel.
+    static constexpr int64_t min_tombstones = 64;
+    static constexpr size_t cache_line_sz = 64;
+
+    // What became of a task that was pushed to an inbox.
+    enum class Push : uint8_t {
+        queued,
+        full,
+        rejected,
+    };
+
+    // An immediate task and the time at which it was queued.
+    struct Entry {
+        Task func;
+        clock::time_point queued;
+    };
+
+    // When and where a task that is being run was queued.
+    struct Origin {
+        clock::time_point queued;
+        TraceKind kind;
+        bool stolen;
+    };
+
+    // Entries that wait under the lock, whose storage comes from the slab allocator.
+    using EntryList = std::deque<Entry, detail::SlabAllocator<Entry>>;
+
+    // The immediate tasks of a priority class. `overflow` only holds tasks while `inbox` is full.
+    struct Queue {
+        Queue(size_t capacity) : inbox{capacity} {}
+
+        MpmcQueue<Entry> inbox;
+        // Guarded by `m`.
+        EntryList overflow{};
+        // Set while `overflow` is not empty, so that thieves only take the lock if there is
+        // something to steal.
+        std::atomic_bool overflowing{};
+        // Queueing delay of the tasks taken so far, in nanoseconds.
+        std::atomic<uint64_t> tasks{};
+        std::atomic<uint64_t> total_delay{};
+        std::atomic<uint64_t> max_delay{};
+        // Number of tasks taken so far per `Histogram` bucket of their queueing delay.
+        std::atomic<uint64_t> delays[Histogram::num_buckets]{};
+    };
+
+    // What the thread running the `Worker` is doing.
+    enum class Phase : uint8_t {
+        stopped,
+        busy,
+        idle,
+    };
+
+    // Counters of the tasks that found a bounded inbox full, which producers write.
+    struct alignas(cache_line_sz) OverflowCounters {
+        std::atomic<uint64_t> overflowed{};
+        std::atomic<uint64_t> dropped{};
+    };
+
+    // Number of immediate tasks queued on the `Worker`, which producers increment before pushing a
+    // task and consumers decrement after taking one, so that it never falls below the true count.
+    // On a cache line of its own, as both sides write it.
+    struct alignas(cache_line_sz) Depth {
+        std::atomic<size_t> tasks{};
+    };
+
+    // Counters that only the thread running the `Worker` writes, on a cache line of their own so
+    // that producers and thieves never contend with them.
+    struct alignas(cache_line_sz) Counters {
+        std::atomic<uint64_t> executed{};
+        std::atomic<uint64_t> stolen{};
+        // Time spent busy and idle in nanoseconds, up to the start of the current phase.
+        std::atomic<uint64_t> busy{};
+        std::atomic<uint64_t> idle{};
+        std::atomic<Phase> phase{Phase::stopped};
+        // Start of the current phase, in nanoseconds since the epoch of `clock`.
+        std::atomic<int64_t> since{};
+    };
+
+    // Indexed by `Priority`.
+    Queue queues[num_priorities];
+    Depth depth;
+    Counters counters;
+    // Zero unless the inboxes are bounded, in which case they never spill over.
+    size_t queue_capacity;
+    OverflowPolicy overflow_policy;
+    OverflowCounters overflow_counters;
+    // Producers that block on a full inbox wait on `room`, which consumers only notify if
+    // `blocking` is set.
+    bool blocking;
+    EventCount room;
+    // Number of immediate tasks the `Worker` has taken from its own queues, which decides the class
+    // it serves first on its next turn.
+    uint32_t turn{0};
+    // Immediate tasks that cannot be stolen, guarded by `m`. `has_pinned` is set while `pinned` is
+    // not empty, so that `run` only takes the lock when there is one.
+    EntryList pinned{};
+    std::atomic_bool has_pinned{};
+    TimerWheel timers;
+    // Number of cancelled tasks in `timers`, which is incremented by whoever cancels them.
+    std::shared_ptr<std::atomic<int64_t>> tombstones{std::make_shared<std::atomic<int64_t>>(0)};
     std::mutex m;
-    std::condition_variable cv;
-    clock::time_point deadline;
-    bool terminated{};
-    bool draining{};
+    EventCount events;
+    // Deadline of the earliest deferred task. Written under `m` but read without it, so that
+    // `run` only takes the lock for deferred tasks once one is due.
+    std::atomic<clock::time_point> deadline;
+    std::atomic_bool terminated{};
+    std::atomic_bool draining{};
+    // Number of threads in the middle of pushing an immediate task, which `drain` must wait for.
+    std::atomic_uint producers{};
     Latch drain_latch{};
 
-    bool do_schedule(const Task& task);
+    // Near peers come first.
+    std::vector<Worker*> peers{};
+    size_t num_near_peers{0};
+    std::minstd_rand rng;
+    // Set while the `Worker` has run out of local work, so that producers know to wake it. A
+    // producer that clears the flag hands the `Worker` a task to steal.
+    std::atomic_bool idle{};
+    std::atomic_uint next_peer{};
+    WaitStrategy wait_strategy;
+    uint32_t spin_budget{min_spins};
+    std::atomic_bool stopped{};
+    std::function<void()> backlog_handler{};
+    EventCount* helpers{nullptr};
+    clock::duration idle_timeout{};
+    std::function<bool()> may_retire{};
+    // Set once the `Worker` stops waiting for work, until it takes a task.
+    bool woken{false};
+    // Null unless tracing is enabled.
+    std::unique_ptr<TraceBuffer> tracer{};
+    // Where the task that was taken last came from, which is only tracked for tracing.
+    Origin taken{};
+
+    // Runs tasks until the `Worker` is terminated, drained or retired.
+    void run_tasks();
+    // Runs a task that was just taken, stolen or not.
+    void run_task(Task& func);
+    // Accounts for the time spent in the current phase, and starts `phase`.
+    void enter(Phase phase);
+    // Notes where the task that is being taken came from, for tracing.
+    void took(clock::time_point queued, TraceKind kind, bool stolen);
+    bool schedule_now(Task func, Priority priority);
+    // Pushes `entry` to the inbox of `queue`, or to its overflow list if the inbox is unbounded.
+    // Leaves `entry` untouched unless it is queued.
+    Push push(Queue& queue, Entry& entry);
+    // Applies the overflow policy to `entry`, which found the bounded inbox of `queue` full.
+    // Returns false if the task was rejected.
+    bool overflow(Queue& queue, Entry& entry);
+    // Called whenever a task is taken from an inbox, to let blocked producers know there is room.
+    void made_room();
+    // Called whenever an immediate task is taken or dropped.
+    void dequeued();
+    bool do_schedule(Timer timer);
+    bool pop_timer(Timer& timer);
+    // Returns false, and forgets the tombstone, if `timer` was cancelled. Otherwise, a `timer` that
+    // runs once can no longer be cancelled.
+    bool claim(Timer& timer);
+    // Removes the cancelled tasks from `timers` if they make up most of it, or if the `Worker` is
+    // draining.
+    void collect_tombstones();
+    bool pop(Task& func);
+    bool pop_inbox(Task& func);
+    size_t class_to_serve(size_t i) const;
+    bool inboxes_empty() const;
+    void record(Queue& queue, clock::time_point queued);
+    void run_timer(Timer& timer);
+    bool work_due() const;
+    bool drained() const;
+    bool steal_from_peers(Task& func);
+    bool steal_from(size_t first, size_t last, Task& func);
+    // Same as the public overload, but keeps the entry and its class.
+    bool steal(Entry& entry, size_t& cls);
+    bool poke(size_t first, size_t last);
+    // Waits until there is work, running the wait strategy. Returns true if the `Worker` retires.
+    bool wait_for_work(Task& func);
+    bool has_work(Task& func);
+    bool poke_peer();
+    // Called with a task that was just taken, before running it.
+    void share_backlog();
 };
 
 template <class T>
-bool Worker::schedule(const std::function<void()>& func, T delay, bool periodic) {
-    Task task{func, delay, periodic, clock::now() + delay};
-    std::lock_guard<std::mutex> lk{m};
-    if (do_schedule(task)) {
-        cv.notify_one();
-        return true;
-    }
+TaskHandle Worker::schedule(Task func, T delay, bool periodic) {
+    if (delay == T{} && !periodic) return schedule_cancellable(std::move(func));
 
-    return false;
+    auto cancel = detail::make_cancel_state(tombstones);
+    Timer timer{std::move(func), clock::now() + delay, delay, periodic, cancel};
+    {
+        std::lock_guard<std::mutex> lk{m};
+        if (!do_schedule(std::move(timer))) return {};
+    }
+    // The `Worker` may be blocked until a later deadline.
+    events.notify();
+    return TaskHandle{std::move(cancel)};
 }
 
 } // namespace spindle
@@ -0,0 +1,57 @@
+#include "spindle/barrier.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+TEST(Barrier, InvalidCount) {
+    EXPECT_THROW(spindle::Barrier{0}, std::runtime_error);
+}
+
+TEST(Barrier, SingleThread) {
+    spindle::Barrier barrier{1};
+    for (int i = 0; i < 10; ++i) {
+        barrier.arrive_and_wait();
+    }
+}
+
+TEST(Barrier, Phases) {
+    // In every phase, each thread checks that all threads completed the previous one.
+    constexpr uint32_t num_threads = 8;
+    constexpr int num_phases = 200;
+    std::atomic_int arrivals{};
+    std::atomic_bool ok{true};
+    spindle::Barrier barrier{num_threads};
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&] {
+            for (int phase = 0; phase < num_phases; ++phase) {
+                arrivals++;
+                barrier.arrive_and_wait();
+                if (arrivals < (phase + 1) * static_cast<int>(num_threads)) ok = false;
+                barrier.arrive_and_wait();
+            }
+        });
+    }
+
+    for (auto&& thread : threads) {
+        thread.join();
+    }
+    EXPECT_TRUE(ok);
+    EXPECT_EQ(arrivals, num_threads * num_phases);
+}
+
+TEST(Barrier, ArriveAndDrop) {
+    spindle::Barrier barrier{2};
+    std::thread t{[&] { barrier.arrive_and_drop(); }};
+    barrier.arrive_and_wait();
+    t.join();
+
+    // Only this thread is left in the group.
+    barrier.arrive_and_wait();
+    barrier.arrive_and_wait();
+}
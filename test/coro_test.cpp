@@ -0,0 +1,180 @@
+#include "spindle/coro.h"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "spindle/thread_pool.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+using namespace std::chrono_literals;
+using clock = std::chrono::steady_clock;
+
+spindle::CoTask<int> value(int x) {
+    co_return x;
+}
+
+spindle::CoTask<int> add(int x, int y) {
+    int a = co_await value(x);
+    int b = co_await value(y);
+    co_return a + b;
+}
+
+spindle::CoTask<std::thread::id> thread_id_on(spindle::ThreadPool& pool) {
+    co_await pool.schedule();
+    co_return std::this_thread::get_id();
+}
+
+spindle::CoTask<int> fail() {
+    throw std::runtime_error{"failed"};
+    co_return 0;
+}
+
+spindle::CoTask<> sleep_for_an_hour(spindle::ThreadPool& pool) {
+    co_await pool.sleep_for(1h);
+}
+
+spindle::CoTask<int> count_down(int n) {
+    // Deep recursion relies on symmetric transfer to avoid overflowing the stack.
+    if (n == 0) co_return 0;
+    co_return co_await count_down(n - 1) + 1;
+}
+
+} // namespace
+
+class CoroTest : public testing::Test {
+  protected:
+    spindle::ThreadPool thread_pool{4};
+};
+
+TEST_F(CoroTest, SyncWait) {
+    ASSERT_EQ(spindle::sync_wait(add(1, 2)), 3);
+}
+
+TEST_F(CoroTest, VoidTask) {
+    int x = 0;
+    auto set = [&x]() -> spindle::CoTask<> {
+        x = 1;
+        co_return;
+    };
+    spindle::sync_wait(set());
+    ASSERT_EQ(x, 1);
+}
+
+TEST_F(CoroTest, MoveOnlyResult) {
+    auto make = []() -> spindle::CoTask<std::unique_ptr<int>> {
+        co_return std::make_unique<int>(7);
+    };
+    ASSERT_EQ(*spindle::sync_wait(make()), 7);
+}
+
+TEST_F(CoroTest, Lazy) {
+    bool started = false;
+    auto body = [&started]() -> spindle::CoTask<> {
+        started = true;
+        co_return;
+    };
+    {
+        spindle::CoTask<> task = body();
+        ASSERT_FALSE(started);
+    }
+    ASSERT_FALSE(started);
+}
+
+TEST_F(CoroTest, Schedule) {
+    std::thread::id id = spindle::sync_wait(thread_id_on(thread_pool));
+    ASSERT_NE(id, std::this_thread::get_id());
+}
+
+TEST_F(CoroTest, SleepFor) {
+    auto sleep = [this]() -> spindle::CoTask<clock::duration> {
+        clock::time_point start = clock::now();
+        co_await thread_pool.sleep_for(20ms);
+        co_return clock::now() - start;
+    };
+    ASSERT_GE(spindle::sync_wait(sleep()), 20ms);
+}
+
+TEST_F(CoroTest, Exception) {
+    EXPECT_THROW(spindle::sync_wait(fail()), std::runtime_error);
+
+    auto catch_it = []() -> spindle::CoTask<bool> {
+        try {
+            co_await fail();
+        } catch (const std::runtime_error&) {
+            co_return true;
+        }
+        co_return false;
+    };
+    ASSERT_TRUE(spindle::sync_wait(catch_it()));
+}
+
+TEST_F(CoroTest, SymmetricTransfer) {
+    constexpr int depth = 100'000;
+    ASSERT_EQ(spindle::sync_wait(count_down(depth)), depth);
+}
+
+TEST_F(CoroTest, Spawn) {
+    spindle::Future<int> future = spindle::spawn(thread_pool, add(20, 22));
+    ASSERT_EQ(future.get(), 42);
+}
+
+TEST_F(CoroTest, ManyConcurrentFlows) {
+    // Far more flows than threads sleep at the same time, which only works if sleeping does not
+    // block a thread.
+    constexpr int num_flows = 10'000;
+    std::atomic_int done{0};
+    auto flow = [this, &done]() -> spindle::CoTask<> {
+        co_await thread_pool.sleep_for(50ms);
+        co_await thread_pool.schedule();
+        done++;
+    };
+
+    clock::time_point start = clock::now();
+    std::vector<spindle::Future<void>> futures;
+    for (int i = 0; i < num_flows; ++i) {
+        futures.push_back(spindle::spawn(thread_pool, flow()));
+    }
+    spindle::when_all(std::move(futures)).get();
+
+    ASSERT_EQ(done, num_flows);
+    ASSERT_LT(clock::now() - start, 5s);
+}
+
+TEST_F(CoroTest, RejectedAfterTearDown) {
+    thread_pool.tear_down();
+    // The pool no longer accepts tasks, so coroutines continue on the awaiting thread.
+    ASSERT_EQ(spindle::sync_wait(thread_id_on(thread_pool)), std::this_thread::get_id());
+
+    auto sleep = [this]() -> spindle::CoTask<clock::duration> {
+        clock::time_point start = clock::now();
+        co_await thread_pool.sleep_for(20ms);
+        co_return clock::now() - start;
+    };
+    ASSERT_GE(spindle::sync_wait(sleep()), 20ms);
+
+    spindle::Future<int> future = spindle::spawn(thread_pool, add(20, 22));
+    ASSERT_EQ(future.get(), 42);
+}
+
+TEST(CoroTearDownTest, DestroysSuspendedCoroutine) {
+    spindle::Future<void> future;
+    {
+        spindle::ThreadPool pool{1};
+        future = spindle::spawn(pool, sleep_for_an_hour(pool));
+        auto deferred = [&pool] { return pool.metrics().workers[0].deferred; };
+        while (deferred() == 0) {
+            std::this_thread::yield();
+        }
+        pool.tear_down();
+    }
+    // The pool dropped the task that would have resumed the coroutine.
+    EXPECT_THROW(future.get(), std::future_error);
+}
@@ -0,0 +1,17 @@
+#ifndef SPINDLE_COUNTING_ALLOCATOR_H_
+#define SPINDLE_COUNTING_ALLOCATOR_H_
+
+#include <cstdint>
+
+namespace spindle {
+namespace test {
+
+// Returns the number of calls into the global allocator so far, on any thread. Binaries that link
+// `counting_allocator.cpp` replace the global `operator new` with one that counts its calls, so
+// they do not share a binary with others.
+uint64_t global_allocations();
+
+} // namespace test
+} // namespace spindle
+
+#endif // SPINDLE_COUNTING_ALLOCATOR_H_
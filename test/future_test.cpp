@@ -0,0 +1,186 @@
+#include "spindle/future.h"
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "spindle/thread_pool.h"
+
+#include "gtest/gtest.h"
+
+class FutureTest : public testing::Test {
+  protected:
+    spindle::ThreadPool thread_pool{4};
+};
+
+TEST_F(FutureTest, SubmitValue) {
+    spindle::Future<int> future = thread_pool.submit([] { return 42; });
+    ASSERT_EQ(future.valid(), true);
+    ASSERT_EQ(future.get(), 42);
+    ASSERT_EQ(future.valid(), false);
+}
+
+TEST_F(FutureTest, SubmitVoid) {
+    int x = 0;
+    spindle::Future<void> future = thread_pool.submit([&x] { x = 1; });
+    future.get();
+    ASSERT_EQ(x, 1);
+}
+
+TEST_F(FutureTest, SubmitMoveOnlyResult) {
+    spindle::Future<std::unique_ptr<int>> future =
+        thread_pool.submit([] { return std::make_unique<int>(7); });
+    ASSERT_EQ(*future.get(), 7);
+}
+
+TEST_F(FutureTest, SubmitException) {
+    spindle::Future<int> future =
+        thread_pool.submit([]() -> int { throw std::runtime_error{"failed"}; });
+    EXPECT_THROW(future.get(), std::runtime_error);
+}
+
+TEST_F(FutureTest, Wait) {
+    spindle::Latch release{};
+    spindle::Future<int> future = thread_pool.submit([&release] {
+        release.wait();
+        return 1;
+    });
+    ASSERT_EQ(future.is_ready(), false);
+
+    release.decrement();
+    future.wait();
+    ASSERT_EQ(future.is_ready(), true);
+    ASSERT_EQ(future.get(), 1);
+}
+
+TEST_F(FutureTest, ThenChain) {
+    spindle::Future<std::string> future = thread_pool.submit([] { return 20; })
+                                              .then([](int x) { return x + 1; })
+                                              .then([](int x) { return 2 * x; })
+                                              .then([](int x) { return std::to_string(x); });
+    ASSERT_EQ(future.get(), "42");
+}
+
+TEST_F(FutureTest, ThenVoid) {
+    int x = 0;
+    spindle::Future<int> future = thread_pool.submit([&x] { x = 1; }).then([&x] { return x + 1; });
+    ASSERT_EQ(future.get(), 2);
+}
+
+TEST_F(FutureTest, ThenOnReadyFuture) {
+    spindle::Future<int> future = thread_pool.submit([] { return 1; });
+    future.wait();
+    ASSERT_EQ(future.then([](int x) { return x + 1; }).get(), 2);
+}
+
+TEST_F(FutureTest, ThenRunsOnPool) {
+    std::thread::id caller = std::this_thread::get_id();
+    spindle::Future<bool> future = thread_pool.submit([] {}).then(
+        [caller] { return std::this_thread::get_id() != caller; });
+    ASSERT_EQ(future.get(), true);
+}
+
+TEST_F(FutureTest, ThenPropagatesException) {
+    bool called = false;
+    spindle::Future<int> future = thread_pool.submit([]() -> int { throw std::logic_error{""}; })
+                                      .then([&called](int x) {
+                                          called = true;
+                                          return x;
+                                      });
+    EXPECT_THROW(future.get(), std::logic_error);
+    ASSERT_EQ(called, false);
+}
+
+TEST_F(FutureTest, ThenThrows) {
+    spindle::Future<void> future = thread_pool.submit([] { return 1; }).then([](int) {
+        throw std::runtime_error{"failed"};
+    });
+    EXPECT_THROW(future.get(), std::runtime_error);
+}
+
+TEST_F(FutureTest, WhenAll) {
+    uint32_t task_count = 64;
+    std::vector<spindle::Future<uint32_t>> futures;
+    for (uint32_t i = 0; i < task_count; ++i) {
+        futures.push_back(thread_pool.submit([i] { return i * i; }));
+    }
+
+    std::vector<uint32_t> results = spindle::when_all(std::move(futures)).get();
+    ASSERT_EQ(results.size(), task_count);
+    for (uint32_t i = 0; i < task_count; ++i) {
+        ASSERT_EQ(results[i], i * i);
+    }
+}
+
+TEST_F(FutureTest, WhenAllEmpty) {
+    std::vector<spindle::Future<int>> futures;
+    ASSERT_EQ(spindle::when_all(std::move(futures)).get().size(), 0);
+}
+
+TEST_F(FutureTest, WhenAllVoid) {
+    std::atomic_int x{};
+    std::vector<spindle::Future<void>> futures;
+    for (int i = 0; i < 16; ++i) {
+        futures.push_back(thread_pool.submit([&x] { x++; }));
+    }
+
+    spindle::when_all(std::move(futures)).get();
+    ASSERT_EQ(x, 16);
+}
+
+TEST_F(FutureTest, WhenAllException) {
+    std::vector<spindle::Future<int>> futures;
+    futures.push_back(thread_pool.submit([] { return 1; }));
+    futures.push_back(thread_pool.submit([]() -> int { throw std::runtime_error{"failed"}; }));
+
+    EXPECT_THROW(spindle::when_all(std::move(futures)).get(), std::runtime_error);
+}
+
+TEST_F(FutureTest, WhenAny) {
+    spindle::Latch release{};
+    std::vector<spindle::Future<int>> futures;
+    futures.push_back(thread_pool.submit([&release] {
+        release.wait();
+        return 1;
+    }));
+    futures.push_back(thread_pool.submit([] { return 2; }));
+
+    std::pair<size_t, int> result = spindle::when_any(std::move(futures)).get();
+    ASSERT_EQ(result.first, 1);
+    ASSERT_EQ(result.second, 2);
+    // The first task must return before `release` goes out of scope.
+    release.decrement();
+    thread_pool.drain();
+}
+
+TEST_F(FutureTest, WhenAnyEmpty) {
+    std::vector<spindle::Future<int>> futures;
+    EXPECT_THROW(spindle::when_any(std::move(futures)), std::runtime_error);
+}
+
+TEST_F(FutureTest, Promise) {
+    spindle::Promise<int> promise{};
+    spindle::Future<int> future = promise.get_future();
+    ASSERT_EQ(future.is_ready(), false);
+
+    std::thread thread{[&promise] { promise.set_value(3); }};
+    ASSERT_EQ(future.get(), 3);
+    thread.join();
+}
+
+TEST_F(FutureTest, BrokenPromise) {
+    spindle::Future<int> future;
+    {
+        spindle::Promise<int> promise{};
+        future = promise.get_future();
+    }
+    EXPECT_THROW(future.get(), std::future_error);
+}
+
+TEST_F(FutureTest, RejectedTask) {
+    thread_pool.drain();
+    spindle::Future<int> future = thread_pool.submit([] { return 1; });
+    EXPECT_THROW(future.get(), std::future_error);
+}
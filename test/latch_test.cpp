@@ -1,6 +1,9 @@
 #include "spindle/latch.h"
 
 #include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
 #include <thread>
 #include <vector>
 
@@ -56,3 +59,65 @@ TEST(Latch, ManyThreads) {
         if (thread.joinable()) thread.join();
     }
 }
+
+TEST(Latch, WeightTooLarge) {
+    EXPECT_THROW(spindle::Latch{spindle::Latch::max_weight + 1}, std::runtime_error);
+}
+
+TEST(Latch, CountDown) {
+    spindle::Latch latch{10};
+    latch.count_down(4);
+    ASSERT_FALSE(latch.try_wait());
+    latch.count_down(6);
+    ASSERT_TRUE(latch.try_wait());
+    latch.wait();
+}
+
+TEST(Latch, CountDownMoreThanWeight) {
+    spindle::Latch latch{3};
+    latch.count_down(100);
+    ASSERT_TRUE(latch.try_wait());
+    latch.count_down(1);
+    latch.wait();
+}
+
+TEST(Latch, TryWait) {
+    spindle::Latch latch{};
+    ASSERT_FALSE(latch.try_wait());
+    latch.decrement();
+    ASSERT_TRUE(latch.try_wait());
+}
+
+TEST(Latch, ManyWaiters) {
+    uint32_t num_waiters = 8;
+    std::vector<std::thread> threads;
+    std::atomic_int released{};
+    spindle::Latch latch{};
+
+    for (int i = 0; i < num_waiters; ++i) {
+        threads.emplace_back([&] {
+            latch.wait();
+            released++;
+        });
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    EXPECT_EQ(released, 0);
+    latch.decrement();
+
+    for (auto&& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(released, num_waiters);
+}
+
+TEST(Latch, DestroyAfterWait) {
+    // The thread that releases the latch must not touch it once the waiter may have destroyed it.
+    for (int i = 0; i < 1000; ++i) {
+        auto latch = std::make_unique<spindle::Latch>();
+        std::thread t{[l = latch.get()] { l->decrement(); }};
+        latch->wait();
+        latch.reset();
+        t.join();
+    }
+}
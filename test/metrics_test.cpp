@@ -0,0 +1,87 @@
+#include "spindle/metrics.h"
+
+#include <chrono>
+#include <cmath>
+#include <string>
+
+#include "gtest/gtest.h"
+
+using std::chrono::nanoseconds;
+
+TEST(HistogramTest, Buckets) {
+    // Small values have a bucket each, and every power of two above is split into four.
+    for (int64_t v = 0; v < 8; ++v) {
+        EXPECT_EQ(spindle::Histogram::bucket(nanoseconds{v}), v);
+    }
+    EXPECT_EQ(spindle::Histogram::bucket(nanoseconds{-1}), 0);
+    EXPECT_EQ(spindle::Histogram::bucket(nanoseconds{9}), 8);
+    EXPECT_EQ(spindle::Histogram::bucket(nanoseconds{10}), 9);
+    EXPECT_EQ(spindle::Histogram::bucket(nanoseconds{1000}), 35);
+    EXPECT_EQ(spindle::Histogram::bucket(nanoseconds::max()), spindle::Histogram::num_buckets - 1);
+
+    for (size_t b = 0; b < spindle::Histogram::num_buckets; ++b) {
+        nanoseconds lower = spindle::Histogram::lower_bound(b);
+        EXPECT_EQ(spindle::Histogram::bucket(lower), b);
+        if (b > 0) {
+            EXPECT_EQ(spindle::Histogram::bucket(lower - nanoseconds{1}), b - 1);
+        }
+    }
+}
+
+TEST(HistogramTest, Quantiles) {
+    spindle::Histogram histogram;
+    EXPECT_EQ(histogram.count(), 0);
+    EXPECT_EQ(histogram.quantile(0.5), nanoseconds{0});
+
+    for (int64_t v = 1; v <= 100; ++v) {
+        histogram.add(std::chrono::microseconds{v});
+    }
+    EXPECT_EQ(histogram.count(), 100);
+    EXPECT_EQ(histogram.sum, std::chrono::microseconds{5050});
+
+    // Quantiles are overestimated by at most a quarter.
+    for (double q : {0.01, 0.5, 0.9, 0.99, 1.0}) {
+        nanoseconds exact = std::chrono::microseconds{std::llround(q * 100)};
+        EXPECT_GE(histogram.quantile(q), exact);
+        EXPECT_LE(histogram.quantile(q), exact + exact / 4);
+    }
+
+    spindle::Histogram other;
+    other.add(std::chrono::seconds{1});
+    histogram += other;
+    EXPECT_EQ(histogram.count(), 101);
+    EXPECT_GE(histogram.quantile(1.0), std::chrono::seconds{1});
+}
+
+TEST(MetricsTest, Prometheus) {
+    spindle::Metrics metrics{2, {}, 256};
+    metrics.workers.resize(2);
+    metrics.workers[0].queue_depth[1] = 5;
+    metrics.workers[0].executed = 7;
+    metrics.workers[1].busy_time = std::chrono::milliseconds{1500};
+    metrics.workers[1].queueing_delay[0].add(std::chrono::microseconds{3});
+    metrics.workers[1].queueing_delay[0].add(std::chrono::seconds{100});
+
+    std::string text = metrics.to_prometheus("pool");
+    EXPECT_NE(text.find("# TYPE pool_threads gauge\npool_threads 2\n"), std::string::npos);
+    EXPECT_NE(text.find("# TYPE pool_tasks_executed_total counter\n"
+                        "pool_tasks_executed_total{worker=\"0\"} 7\n"
+                        "pool_tasks_executed_total{worker=\"1\"} 0\n"),
+              std::string::npos);
+    EXPECT_NE(text.find("pool_busy_seconds_total{worker=\"1\"} 1.5\n"), std::string::npos);
+    EXPECT_NE(text.find("pool_queue_depth{worker=\"0\",priority=\"normal\"} 5\n"),
+              std::string::npos);
+    EXPECT_NE(text.find("pool_queue_capacity 256\n"), std::string::npos);
+
+    // Buckets are cumulative, and the slowest task only counts towards the last one.
+    std::string bucket = "pool_queueing_delay_seconds_bucket{priority=\"critical\",le=";
+    EXPECT_NE(text.find("# TYPE pool_queueing_delay_seconds histogram\n"), std::string::npos);
+    EXPECT_NE(text.find(bucket + "\"1.024e-06\"} 0\n"), std::string::npos);
+    EXPECT_NE(text.find(bucket + "\"4.096e-06\"} 1\n"), std::string::npos);
+    EXPECT_NE(text.find(bucket + "\"17.179869184\"} 1\n"), std::string::npos);
+    EXPECT_NE(text.find(bucket + "\"+Inf\"} 2\n"), std::string::npos);
+    EXPECT_NE(text.find("pool_queueing_delay_seconds_count{priority=\"critical\"} 2\n"),
+              std::string::npos);
+    EXPECT_NE(text.find("pool_queueing_delay_seconds_count{priority=\"normal\"} 0\n"),
+              std::string::npos);
+}
@@ -0,0 +1,102 @@
+#include "mpmc_queue.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+TEST(MpmcQueue, InvalidCapacity) {
+    EXPECT_THROW(spindle::MpmcQueue<int>{0}, std::runtime_error);
+    EXPECT_THROW(spindle::MpmcQueue<int>{1}, std::runtime_error);
+    EXPECT_THROW(spindle::MpmcQueue<int>{24}, std::runtime_error);
+}
+
+TEST(MpmcQueue, Fifo) {
+    spindle::MpmcQueue<int> queue{4};
+    int x;
+
+    ASSERT_EQ(queue.empty(), true);
+    ASSERT_EQ(queue.pop(x), false);
+
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_EQ(queue.push(i), true);
+    }
+    ASSERT_EQ(queue.push(4), false); // Full.
+    ASSERT_EQ(queue.empty(), false);
+    ASSERT_EQ(queue.size(), 4);
+
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_EQ(queue.pop(x), true);
+        ASSERT_EQ(x, i);
+    }
+    ASSERT_EQ(queue.empty(), true);
+    ASSERT_EQ(queue.size(), 0);
+}
+
+TEST(MpmcQueue, WrapAround) {
+    spindle::MpmcQueue<int> queue{2};
+    int x;
+
+    for (int i = 0; i < 16; ++i) {
+        ASSERT_EQ(queue.push(i), true);
+        ASSERT_EQ(queue.pop(x), true);
+        ASSERT_EQ(x, i);
+    }
+}
+
+TEST(MpmcQueue, PushBulk) {
+    spindle::MpmcQueue<int> queue{8};
+    int values[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    int x;
+
+    ASSERT_EQ(queue.push(-1), true);
+    ASSERT_EQ(queue.push_bulk(values, 3), 3);
+    // Only four cells are left.
+    ASSERT_EQ(queue.push_bulk(values + 3, 7), 4);
+    ASSERT_EQ(queue.push_bulk(values + 7, 3), 0);
+
+    ASSERT_EQ(queue.pop(x), true);
+    ASSERT_EQ(x, -1);
+    for (int i = 0; i < 7; ++i) {
+        ASSERT_EQ(queue.pop(x), true);
+        ASSERT_EQ(x, i);
+    }
+    ASSERT_EQ(queue.empty(), true);
+}
+
+TEST(MpmcQueue, ManyProducersManyConsumers) {
+    uint32_t thread_count = 4;
+    uint32_t items_per_thread = 16 * 1024;
+    spindle::MpmcQueue<uint32_t> queue{64};
+    std::vector<std::thread> threads;
+    std::atomic<uint64_t> sum{};
+    std::atomic<uint32_t> popped{};
+
+    for (int i = 0; i < thread_count; ++i) {
+        threads.emplace_back([&, i] {
+            for (uint32_t j = 0; j < items_per_thread; ++j) {
+                while (!queue.push(i * items_per_thread + j)) std::this_thread::yield();
+            }
+        });
+        threads.emplace_back([&] {
+            uint32_t x;
+            while (popped < thread_count * items_per_thread) {
+                if (queue.pop(x)) {
+                    sum += x;
+                    popped++;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    for (auto&& thread : threads) {
+        thread.join();
+    }
+
+    uint64_t n = thread_count * items_per_thread;
+    ASSERT_EQ(popped, n);
+    ASSERT_EQ(sum, n * (n - 1) / 2);
+}
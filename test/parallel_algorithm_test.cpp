@@ -0,0 +1,214 @@
+#include "spindle/parallel_algorithm.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "spindle/thread_pool.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+std::vector<int> random_ints(size_t n, int max) {
+    std::minstd_rand rng{42};
+    std::uniform_int_distribution<int> dist{0, max};
+    std::vector<int> v(n);
+    for (int& x : v) {
+        x = dist(rng);
+    }
+    return v;
+}
+
+// The affine function `x -> a * x + b`. Composition is associative but not commutative.
+struct Affine {
+    uint64_t a;
+    uint64_t b;
+
+    bool operator==(const Affine& other) const {
+        return a == other.a && b == other.b;
+    }
+};
+
+Affine compose(const Affine& f, const Affine& g) {
+    return {g.a * f.a, g.a * f.b + g.b};
+}
+
+// An element that can only be moved, and which reads as its value.
+struct MoveOnly {
+    explicit MoveOnly(int value) : value(value) {}
+    MoveOnly(MoveOnly&&) = default;
+    MoveOnly& operator=(MoveOnly&&) = default;
+
+    operator int() const {
+        return value;
+    }
+
+    int value;
+};
+
+} // namespace
+
+class ParallelAlgorithmTest : public testing::Test {
+  protected:
+    spindle::ThreadPool thread_pool{4};
+};
+
+TEST_F(ParallelAlgorithmTest, Sort) {
+    for (size_t n : {0, 1, 100, 5000, 100'000}) {
+        std::vector<int> v = random_ints(n, 1000);
+        std::vector<int> expected = v;
+        std::sort(expected.begin(), expected.end());
+        spindle::parallel_sort(thread_pool, v.begin(), v.end());
+        ASSERT_EQ(v, expected) << "size " << n;
+    }
+}
+
+TEST_F(ParallelAlgorithmTest, SortWithComparator) {
+    std::vector<int> v = random_ints(100'000, 1'000'000);
+    spindle::parallel_sort(thread_pool, v.begin(), v.end(), std::greater<>{});
+    ASSERT_TRUE(std::is_sorted(v.begin(), v.end(), std::greater<>{}));
+}
+
+TEST_F(ParallelAlgorithmTest, SortMoveOnly) {
+    std::vector<int> values = random_ints(20'000, 1000);
+    std::vector<std::unique_ptr<int>> v;
+    for (int x : values) {
+        v.push_back(std::make_unique<int>(x));
+    }
+    spindle::parallel_sort(thread_pool, v.begin(), v.end(), [](const auto& lhs, const auto& rhs) {
+        return *lhs < *rhs;
+    });
+
+    std::sort(values.begin(), values.end());
+    for (size_t i = 0; i < v.size(); ++i) {
+        ASSERT_EQ(*v[i], values[i]);
+    }
+}
+
+TEST_F(ParallelAlgorithmTest, Transform) {
+    std::vector<int> v = random_ints(100'000, 1000);
+    std::vector<int> doubled(v.size());
+    auto end = spindle::parallel_transform(
+        thread_pool, v.begin(), v.end(), doubled.begin(), [](int x) { return 2 * x; });
+    ASSERT_EQ(end, doubled.end());
+    for (size_t i = 0; i < v.size(); ++i) {
+        ASSERT_EQ(doubled[i], 2 * v[i]);
+    }
+
+    std::vector<int> diff(v.size());
+    spindle::parallel_transform(
+        thread_pool, doubled.begin(), doubled.end(), v.begin(), diff.begin(), std::minus<>{});
+    ASSERT_EQ(diff, v);
+}
+
+TEST_F(ParallelAlgorithmTest, InclusiveScan) {
+    for (size_t n : {0, 1, 100, 5000, 100'000}) {
+        std::vector<int> v = random_ints(n, 1000);
+        std::vector<int> expected(n);
+        std::partial_sum(v.begin(), v.end(), expected.begin());
+        std::vector<int> out(n);
+        auto end = spindle::parallel_inclusive_scan(thread_pool, v.begin(), v.end(), out.begin());
+        ASSERT_EQ(end, out.end());
+        ASSERT_EQ(out, expected) << "size " << n;
+
+        // In place.
+        spindle::parallel_inclusive_scan(thread_pool, v.begin(), v.end(), v.begin());
+        ASSERT_EQ(v, expected) << "size " << n;
+    }
+}
+
+TEST_F(ParallelAlgorithmTest, InclusiveScanKeepsOrder) {
+    std::vector<int> values = random_ints(50'000, 1000);
+    std::vector<Affine> v;
+    for (int x : values) {
+        v.push_back({static_cast<uint64_t>(x) | 1, static_cast<uint64_t>(x)});
+    }
+    std::vector<Affine> expected(v.size());
+    std::partial_sum(v.begin(), v.end(), expected.begin(), compose);
+    std::vector<Affine> out(v.size());
+    spindle::parallel_inclusive_scan(thread_pool, v.begin(), v.end(), out.begin(), compose);
+    ASSERT_EQ(out, expected);
+}
+
+TEST_F(ParallelAlgorithmTest, InclusiveScanAccumulatesInResultType) {
+    for (size_t n : {1, 100, 100'000}) {
+        std::vector<int> values = random_ints(n, 255);
+        std::vector<uint8_t> v(values.begin(), values.end());
+        std::vector<int> expected(n);
+        std::partial_sum(values.begin(), values.end(), expected.begin());
+        // `std::plus<>` promotes the bytes to `int`, which holds the sums.
+        std::vector<int> out(n);
+        spindle::parallel_inclusive_scan(thread_pool, v.begin(), v.end(), out.begin());
+        ASSERT_EQ(out, expected) << "size " << n;
+    }
+}
+
+TEST_F(ParallelAlgorithmTest, InclusiveScanMoveOnlyInput) {
+    for (size_t n : {1, 100, 100'000}) {
+        std::vector<int> values = random_ints(n, 1000);
+        std::vector<MoveOnly> v;
+        for (int x : values) {
+            v.emplace_back(x);
+        }
+        std::vector<int> expected(n);
+        std::partial_sum(values.begin(), values.end(), expected.begin());
+        std::vector<int> out(n);
+        spindle::parallel_inclusive_scan(thread_pool, v.begin(), v.end(), out.begin());
+        ASSERT_EQ(out, expected) << "size " << n;
+    }
+}
+
+TEST_F(ParallelAlgorithmTest, FindIf) {
+    std::vector<int> v(100'000);
+    std::iota(v.begin(), v.end(), 0);
+    for (int target : {0, 1, 4095, 50'000, 99'999}) {
+        auto it = spindle::parallel_find_if(
+            thread_pool, v.begin(), v.end(), [&](int x) { return x >= target && x % 2 == 1; });
+        int expected = target % 2 == 1 ? target : target + 1;
+        if (expected >= static_cast<int>(v.size())) {
+            ASSERT_EQ(it, v.end());
+        } else {
+            ASSERT_EQ(*it, expected);
+        }
+    }
+
+    auto none = spindle::parallel_find_if(thread_pool, v.begin(), v.end(), [](int x) {
+        return x < 0;
+    });
+    ASSERT_EQ(none, v.end());
+    std::vector<int> empty;
+    ASSERT_EQ(spindle::parallel_find_if(thread_pool, empty.begin(), empty.end(), [](int) {
+                  return true;
+              }),
+              empty.end());
+}
+
+TEST_F(ParallelAlgorithmTest, FindIfStopsEarly) {
+    std::vector<int> v(1'000'000);
+    std::atomic<size_t> calls{0};
+    auto it = spindle::parallel_find_if(thread_pool, v.begin(), v.end(), [&](int) {
+        calls++;
+        return true;
+    });
+    ASSERT_EQ(it, v.begin());
+    // Every piece stops after at most one stride once the first element matches.
+    ASSERT_LT(calls, v.size() / 10);
+}
+
+TEST_F(ParallelAlgorithmTest, Exception) {
+    std::vector<int> v = random_ints(100'000, 1000);
+    std::vector<int> out(v.size());
+    EXPECT_THROW(spindle::parallel_transform(thread_pool, v.begin(), v.end(), out.begin(),
+                                             [](int x) -> int {
+                                                 if (x == 500) throw std::runtime_error{"500"};
+                                                 return x;
+                                             }),
+                 std::runtime_error);
+}
@@ -0,0 +1,193 @@
+#include "spindle/parallel_for.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "spindle/thread_pool.h"
+
+#include "gtest/gtest.h"
+
+class ParallelForTest : public testing::Test {
+  protected:
+    spindle::ThreadPool thread_pool{4};
+};
+
+TEST_F(ParallelForTest, VisitEachIndexOnce) {
+    constexpr int n = 100'000;
+    std::unique_ptr<std::atomic_int[]> visits{new std::atomic_int[n]{}};
+
+    spindle::parallel_for(thread_pool, 0, n, [&](int i) {
+        visits[i]++;
+    });
+
+    for (int i = 0; i < n; ++i) {
+        ASSERT_EQ(visits[i], 1) << "index " << i;
+    }
+}
+
+TEST_F(ParallelForTest, EmptyRange) {
+    std::atomic_int calls{0};
+    spindle::parallel_for(thread_pool, 5, 5, [&](int) { calls++; });
+    spindle::parallel_for(thread_pool, 5, 0, [&](int) { calls++; });
+    ASSERT_EQ(calls, 0);
+}
+
+TEST_F(ParallelForTest, SingleIndex) {
+    std::atomic_int sum{0};
+    spindle::parallel_for(thread_pool, 7, 8, [&](int i) { sum += i; });
+    ASSERT_EQ(sum, 7);
+}
+
+TEST_F(ParallelForTest, Iterators) {
+    std::vector<int> v(10'000);
+    spindle::parallel_for(thread_pool, v.begin(), v.end(), [&](std::vector<int>::iterator it) {
+        *it = static_cast<int>(it - v.begin());
+    });
+
+    for (size_t i = 0; i < v.size(); ++i) {
+        ASSERT_EQ(v[i], i);
+    }
+}
+
+TEST_F(ParallelForTest, UsesMultipleThreads) {
+    std::mutex m;
+    std::vector<std::thread::id> ids;
+    spindle::parallel_for(thread_pool, 0, 64, [&](int) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{5});
+        std::lock_guard<std::mutex> lk{m};
+        if (std::find(ids.begin(), ids.end(), std::this_thread::get_id()) == ids.end()) {
+            ids.push_back(std::this_thread::get_id());
+        }
+    });
+    ASSERT_GT(ids.size(), 1);
+}
+
+TEST_F(ParallelForTest, SplitsImbalancedLoop) {
+    // All the work is in the last iterations, so the piece that holds them must be split further
+    // for the loop to finish in reasonable time.
+    constexpr int n = 1024;
+    std::atomic_int count{0};
+    spindle::parallel_for(thread_pool, 0, n, [&](int i) {
+        if (i >= n - 64) std::this_thread::sleep_for(std::chrono::milliseconds{2});
+        count++;
+    });
+    ASSERT_EQ(count, n);
+}
+
+TEST_F(ParallelForTest, NestedLoops) {
+    constexpr int n = 64;
+    std::atomic_int count{0};
+    spindle::parallel_for(thread_pool, 0, n, [&](int) {
+        spindle::parallel_for(thread_pool, 0, n, [&](int) { count++; });
+    });
+    ASSERT_EQ(count, n * n);
+}
+
+TEST_F(ParallelForTest, CalledFromPoolThread) {
+    std::promise<int> result;
+    thread_pool.execute([&] {
+        std::atomic_int sum{0};
+        spindle::parallel_for(thread_pool, 0, 1000, [&](int i) { sum += i; });
+        result.set_value(sum);
+    });
+    ASSERT_EQ(result.get_future().get(), 999 * 1000 / 2);
+}
+
+TEST_F(ParallelForTest, Exception) {
+    std::atomic_int calls{0};
+    EXPECT_THROW(spindle::parallel_for(thread_pool,
+                                       0,
+                                       100'000,
+                                       [&](int i) {
+                                           calls++;
+                                           if (i == 500) throw std::runtime_error{"failed"};
+                                       }),
+                 std::runtime_error);
+    ASSERT_LE(calls, 100'000);
+
+    // The pool is still usable.
+    std::atomic_int count{0};
+    spindle::parallel_for(thread_pool, 0, 100, [&](int) { count++; });
+    ASSERT_EQ(count, 100);
+}
+
+TEST_F(ParallelForTest, Reduce) {
+    constexpr int64_t n = 1'000'000;
+    int64_t sum = spindle::parallel_reduce(
+        thread_pool,
+        int64_t{0},
+        n,
+        int64_t{0},
+        [](int64_t b, int64_t e, int64_t acc) {
+            for (; b != e; ++b) {
+                acc += b;
+            }
+            return acc;
+        },
+        std::plus<int64_t>{});
+    ASSERT_EQ(sum, n * (n - 1) / 2);
+}
+
+TEST_F(ParallelForTest, ReduceEmptyRange) {
+    int result = spindle::parallel_reduce(
+        thread_pool, 0, 0, 42, [](int, int, int) { return 0; }, std::plus<int>{});
+    ASSERT_EQ(result, 42);
+}
+
+TEST_F(ParallelForTest, ReducePreservesOrder) {
+    // String concatenation is associative but not commutative.
+    constexpr int n = 2000;
+    std::string expected;
+    for (int i = 0; i < n; ++i) {
+        expected += static_cast<char>('a' + i % 26);
+    }
+
+    std::string result = spindle::parallel_reduce(
+        thread_pool,
+        0,
+        n,
+        std::string{},
+        [](int b, int e, std::string acc) {
+            for (; b != e; ++b) {
+                acc += static_cast<char>('a' + b % 26);
+            }
+            return acc;
+        },
+        [](std::string lhs, const std::string& rhs) { return lhs + rhs; });
+    ASSERT_EQ(result, expected);
+}
+
+TEST_F(ParallelForTest, TransformReduce) {
+    std::vector<int> v(10'000);
+    std::iota(v.begin(), v.end(), 1);
+
+    int64_t sum_of_squares = spindle::parallel_transform_reduce(
+        thread_pool,
+        v.cbegin(),
+        v.cend(),
+        int64_t{0},
+        std::plus<int64_t>{},
+        [](std::vector<int>::const_iterator it) { return int64_t{*it} * *it; });
+
+    int64_t expected = 0;
+    for (int x : v) {
+        expected += int64_t{x} * x;
+    }
+    ASSERT_EQ(sum_of_squares, expected);
+}
+
+TEST_F(ParallelForTest, TryRunOne) {
+    ASSERT_FALSE(thread_pool.try_run_one());
+    ASSERT_EQ(thread_pool.size(), 4);
+}
@@ -0,0 +1,126 @@
+#include "scheduler.h"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "spindle/latch.h"
+
+#include "gtest/gtest.h"
+
+// Due tasks run right away on the thread of the `Scheduler`.
+class SchedulerTest : public ::testing::Test {
+  protected:
+    using ms = std::chrono::milliseconds;
+
+    spindle::Scheduler scheduler{
+        std::chrono::microseconds{100}, [](spindle::Task task) { task(); }, {"timer", {}, 0}};
+
+    // Schedules a task at a fixed rate that records when each run starts, the first of which takes
+    // `first_run` long, and waits for `num_runs` runs. Returns the start of each run relative to
+    // the first deadline.
+    std::vector<ms> fixed_rate_runs(ms period,
+                                    ms first_run,
+                                    size_t num_runs,
+                                    spindle::MissedRunPolicy policy) {
+        spindle::Latch done{};
+        std::vector<ms> runs;
+        spindle::clock::time_point first = spindle::clock::now() + period;
+        spindle::TaskHandle handle = scheduler.schedule_periodic(
+            [&] {
+                if (runs.size() == num_runs) return;
+                runs.push_back(std::chrono::duration_cast<ms>(spindle::clock::now() - first));
+                if (runs.size() == 1) std::this_thread::sleep_for(first_run);
+                if (runs.size() == num_runs) done.decrement();
+            },
+            period, period, true, policy);
+        done.wait();
+        handle.cancel();
+        // The runs are only read once the thread of the `Scheduler` has exited.
+        scheduler.stop();
+        return runs;
+    }
+};
+
+TEST_F(SchedulerTest, ScheduleAfter) {
+    spindle::Latch done{};
+    spindle::clock::time_point start = spindle::clock::now();
+    spindle::clock::duration delay{};
+    scheduler.schedule_after(
+        [&] {
+            delay = spindle::clock::now() - start;
+            done.decrement();
+        },
+        ms{20});
+    done.wait();
+    ASSERT_GE(delay, ms{20});
+}
+
+TEST_F(SchedulerTest, Cancel) {
+    spindle::Latch done{};
+    bool ran = false;
+    spindle::TaskHandle handle = scheduler.schedule_after([&] { ran = true; }, ms{5});
+    scheduler.schedule_after([&] { done.decrement(); }, ms{10});
+    ASSERT_EQ(handle.cancel(), true);
+    done.wait();
+    ASSERT_EQ(ran, false);
+}
+
+TEST_F(SchedulerTest, FixedRateCatchesUp) {
+    std::vector<ms> runs = fixed_rate_runs(ms{10}, ms{35}, 5, spindle::MissedRunPolicy::catch_up);
+    // The runs due at 10, 20 and 30ms follow the first one back to back.
+    ASSERT_GE(runs[1], ms{35});
+    ASSERT_LT(runs[3], ms{40});
+    ASSERT_GE(runs[4], ms{40});
+}
+
+TEST_F(SchedulerTest, FixedRateSkips) {
+    std::vector<ms> runs = fixed_rate_runs(ms{10}, ms{35}, 3, spindle::MissedRunPolicy::skip);
+    // The runs due at 10, 20 and 30ms are dropped.
+    ASSERT_GE(runs[1], ms{40});
+    ASSERT_GE(runs[2], ms{50});
+}
+
+TEST_F(SchedulerTest, FixedDelay) {
+    spindle::Latch done{};
+    std::vector<spindle::clock::time_point> starts;
+    std::vector<spindle::clock::time_point> ends;
+    spindle::TaskHandle handle = scheduler.schedule_periodic(
+        [&] {
+            if (starts.size() == 3) return;
+            starts.push_back(spindle::clock::now());
+            std::this_thread::sleep_for(ms{5});
+            ends.push_back(spindle::clock::now());
+            if (starts.size() == 3) done.decrement();
+        },
+        ms{0}, ms{10}, false, spindle::MissedRunPolicy::catch_up);
+    done.wait();
+    handle.cancel();
+    scheduler.stop();
+
+    for (size_t i = 1; i < starts.size(); ++i) {
+        ASSERT_GE(starts[i] - ends[i - 1], ms{10});
+    }
+}
+
+TEST_F(SchedulerTest, InvalidPeriod) {
+    EXPECT_THROW(scheduler.schedule_periodic(
+                     [] {}, ms{0}, ms{0}, true, spindle::MissedRunPolicy::catch_up),
+                 std::runtime_error);
+}
+
+TEST_F(SchedulerTest, Drain) {
+    int once = 0;
+    int periodic = 0;
+    scheduler.schedule_after([&] { once++; }, ms{10});
+    scheduler.schedule_periodic(
+        [&] { periodic++; }, ms{100}, ms{100}, true, spindle::MissedRunPolicy::catch_up);
+
+    // Tasks that run once are still dispatched, whereas periodic ones are dropped.
+    spindle::clock::time_point start = spindle::clock::now();
+    scheduler.drain();
+    ASSERT_LT(spindle::clock::now() - start, ms{100});
+    ASSERT_EQ(once, 1);
+    ASSERT_EQ(periodic, 0);
+    ASSERT_EQ(static_cast<bool>(scheduler.schedule_after([] {}, ms{0})), false);
+}
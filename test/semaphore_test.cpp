@@ -0,0 +1,81 @@
+#include "spindle/semaphore.h"
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+TEST(Semaphore, InvalidCount) {
+    EXPECT_THROW(spindle::Semaphore{spindle::Semaphore::max_count + 1}, std::runtime_error);
+}
+
+TEST(Semaphore, TryAcquire) {
+    spindle::Semaphore semaphore{2};
+    ASSERT_TRUE(semaphore.try_acquire());
+    ASSERT_TRUE(semaphore.try_acquire());
+    ASSERT_FALSE(semaphore.try_acquire());
+    semaphore.release();
+    ASSERT_TRUE(semaphore.try_acquire());
+}
+
+TEST(Semaphore, ReleaseMany) {
+    spindle::Semaphore semaphore{};
+    semaphore.release(3);
+    for (int i = 0; i < 3; ++i) {
+        semaphore.acquire();
+    }
+    ASSERT_FALSE(semaphore.try_acquire());
+}
+
+TEST(Semaphore, Overflow) {
+    spindle::Semaphore semaphore{spindle::Semaphore::max_count};
+    EXPECT_THROW(semaphore.release(), std::runtime_error);
+    ASSERT_TRUE(semaphore.try_acquire());
+}
+
+TEST(Semaphore, AcquireBlocks) {
+    spindle::Semaphore semaphore{};
+    std::atomic_bool acquired{};
+    std::thread t{[&] {
+        semaphore.acquire();
+        acquired = true;
+    }};
+
+    std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    EXPECT_FALSE(acquired);
+    semaphore.release();
+    t.join();
+    EXPECT_TRUE(acquired);
+}
+
+TEST(Semaphore, BoundsConcurrency) {
+    constexpr int num_threads = 8;
+    constexpr int permits = 3;
+    spindle::Semaphore semaphore{permits};
+    std::atomic_int inside{};
+    std::atomic_int max_inside{};
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 1000; ++i) {
+                semaphore.acquire();
+                int n = ++inside;
+                int m = max_inside;
+                while (n > m && !max_inside.compare_exchange_weak(m, n)) {
+                }
+                inside--;
+                semaphore.release();
+            }
+        });
+    }
+
+    for (auto&& thread : threads) {
+        thread.join();
+    }
+    EXPECT_LE(max_inside, permits);
+    EXPECT_EQ(semaphore.try_acquire(), true);
+}
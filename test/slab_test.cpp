@@ -0,0 +1,81 @@
+#include "spindle/slab.h"
+
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "counting_allocator.h"
+#include "spindle/latch.h"
+#include "spindle/task.h"
+#include "spindle/thread_pool.h"
+
+#include "gtest/gtest.h"
+
+TEST(SlabTest, ReusesBlocks) {
+    void* p = spindle::detail::slab_allocate(100);
+    spindle::detail::slab_deallocate(p);
+    // Free lists are last in, first out.
+    void* q = spindle::detail::slab_allocate(100);
+    ASSERT_EQ(p, q);
+    spindle::detail::slab_deallocate(q);
+}
+
+TEST(SlabTest, Sizes) {
+    std::vector<void*> blocks;
+    for (size_t size : {size_t{0}, size_t{1}, size_t{48}, size_t{200},
+                        spindle::detail::max_slab_size, 2 * spindle::detail::max_slab_size}) {
+        void* p = spindle::detail::slab_allocate(size);
+        ASSERT_EQ(reinterpret_cast<uintptr_t>(p) % alignof(std::max_align_t), 0);
+        std::memset(p, 0xAB, size);
+        blocks.push_back(p);
+    }
+    for (void* p : blocks) {
+        spindle::detail::slab_deallocate(p);
+    }
+}
+
+TEST(SlabTest, FreeOnAnotherThread) {
+    constexpr int num_blocks = 1000;
+    std::vector<void*> blocks(num_blocks);
+    size_t allocations = 0;
+    for (int round = 0; round < 4; ++round) {
+        uint64_t before = spindle::test::global_allocations();
+        for (void*& p : blocks) {
+            p = spindle::detail::slab_allocate(256);
+        }
+        if (round > 0) allocations += spindle::test::global_allocations() - before;
+
+        std::thread other{[&] {
+            for (void* p : blocks) {
+                spindle::detail::slab_deallocate(p);
+            }
+        }};
+        other.join();
+    }
+    // Once the arena has grown, blocks freed elsewhere come back to it.
+    ASSERT_EQ(allocations, 0);
+}
+
+TEST(SlabTest, TasksDoNotAllocate) {
+    constexpr int num_tasks = 256;
+    spindle::ThreadPool pool{2};
+    char payload[2 * spindle::Task::inline_size]{};
+    std::atomic_int sum{};
+    size_t allocations = 0;
+    for (int round = 0; round < 8; ++round) {
+        spindle::Latch done{num_tasks};
+        uint64_t before = spindle::test::global_allocations();
+        for (int i = 0; i < num_tasks; ++i) {
+            // Too large to be stored inline.
+            pool.execute([payload, &sum, &done] {
+                sum += payload[0] + 1;
+                done.decrement();
+            });
+        }
+        done.wait();
+        if (round > 0) allocations += spindle::test::global_allocations() - before;
+    }
+    ASSERT_EQ(sum, 8 * num_tasks);
+    ASSERT_EQ(allocations, 0);
+}
@@ -0,0 +1,160 @@
+#include "spindle/strand.h"
+
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "spindle/latch.h"
+#include "spindle/thread_pool.h"
+
+#include "gtest/gtest.h"
+
+class StrandTest : public testing::Test {
+  protected:
+    spindle::ThreadPool thread_pool{4};
+};
+
+TEST_F(StrandTest, RunsInOrder) {
+    constexpr int num_producers = 4;
+    constexpr int num_tasks = 1000;
+    spindle::Strand strand{thread_pool};
+    spindle::Latch done{num_producers * num_tasks};
+    std::atomic_bool running{false};
+    bool overlapped = false;
+    // Only touched by tasks of the strand.
+    std::vector<int> last(num_producers, -1);
+    bool out_of_order = false;
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < num_producers; ++p) {
+        producers.emplace_back([&, p] {
+            for (int i = 0; i < num_tasks; ++i) {
+                strand.execute([&, p, i] {
+                    if (running.exchange(true)) overlapped = true;
+                    if (last[p] != i - 1) out_of_order = true;
+                    last[p] = i;
+                    running = false;
+                    done.decrement();
+                });
+            }
+        });
+    }
+    for (std::thread& producer : producers) {
+        producer.join();
+    }
+    done.wait();
+    ASSERT_FALSE(overlapped);
+    ASSERT_FALSE(out_of_order);
+}
+
+TEST_F(StrandTest, ManyStrands) {
+    constexpr int num_strands = 100;
+    constexpr int num_tasks = 3 * spindle::Strand::batch_size;
+    std::vector<spindle::Strand> strands;
+    for (int s = 0; s < num_strands; ++s) {
+        strands.emplace_back(thread_pool);
+    }
+    std::vector<int> counts(num_strands);
+    spindle::Latch done{num_strands * num_tasks};
+    for (int i = 0; i < num_tasks; ++i) {
+        for (int s = 0; s < num_strands; ++s) {
+            strands[s].execute([&, s] {
+                counts[s]++;
+                done.decrement();
+            });
+        }
+    }
+    done.wait();
+    for (int count : counts) {
+        ASSERT_EQ(count, num_tasks);
+    }
+}
+
+TEST_F(StrandTest, NestedExecute) {
+    spindle::Strand strand{thread_pool};
+    spindle::Latch done{};
+    std::vector<int> order;
+    strand.execute([&] {
+        strand.execute([&] {
+            order.push_back(2);
+            done.decrement();
+        });
+        order.push_back(1);
+    });
+    done.wait();
+    ASSERT_EQ(order, (std::vector<int>{1, 2}));
+}
+
+TEST_F(StrandTest, RunningInThisThread) {
+    spindle::Strand strand{thread_pool};
+    spindle::Strand other{thread_pool};
+    spindle::Latch done{};
+    bool in_strand = false;
+    bool in_other = true;
+    strand.execute([&] {
+        in_strand = strand.running_in_this_thread();
+        in_other = other.running_in_this_thread();
+        done.decrement();
+    });
+    done.wait();
+    ASSERT_TRUE(in_strand);
+    ASSERT_FALSE(in_other);
+    ASSERT_FALSE(strand.running_in_this_thread());
+}
+
+TEST_F(StrandTest, OutlivesHandle) {
+    spindle::Latch started{};
+    spindle::Latch release{};
+    spindle::Latch done{};
+    int count = 0;
+    {
+        spindle::Strand strand{thread_pool};
+        strand.execute([&] {
+            started.decrement();
+            release.wait();
+        });
+        strand.execute([&, p = std::make_unique<int>(1)] {
+            count += *p;
+            done.decrement();
+        });
+        started.wait();
+    }
+    release.decrement();
+    done.wait();
+    ASSERT_EQ(count, 1);
+}
+
+TEST_F(StrandTest, ThrowingTask) {
+    spindle::ThreadPool pool{1};
+    spindle::Latch started{};
+    spindle::Latch release{};
+    pool.execute([&] {
+        started.decrement();
+        release.wait();
+    });
+    started.wait();
+
+    spindle::Strand strand{pool};
+    spindle::Latch done{};
+    strand.execute([] { throw std::runtime_error{"failed"}; });
+    strand.execute([&] { done.decrement(); });
+    // The only thread of the pool is busy, so the strand runs on this thread.
+    EXPECT_THROW(pool.try_run_one(), std::runtime_error);
+    ASSERT_FALSE(strand.running_in_this_thread());
+
+    release.decrement();
+    done.wait();
+}
+
+TEST_F(StrandTest, RejectedStrand) {
+    spindle::Strand strand{thread_pool};
+    thread_pool.tear_down();
+    auto token = std::make_shared<int>(0);
+    strand.execute([token] {});
+    strand.execute([token] {});
+    // Each task was dropped as its strand was rejected, rather than left queued on a strand that
+    // is never scheduled again.
+    ASSERT_EQ(token.use_count(), 1);
+}
@@ -0,0 +1,164 @@
+#include "spindle/task_graph.h"
+
+#include <atomic>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include "spindle/thread_pool.h"
+
+#include "gtest/gtest.h"
+
+class TaskGraphTest : public testing::Test {
+  protected:
+    spindle::ThreadPool thread_pool{4};
+};
+
+TEST_F(TaskGraphTest, EmptyGraph) {
+    spindle::TaskGraph graph;
+    graph.run(thread_pool);
+    ASSERT_EQ(graph.size(), 0);
+}
+
+TEST_F(TaskGraphTest, SingleNode) {
+    spindle::TaskGraph graph;
+    int x = 0;
+    graph.add([&x] { x = 1; });
+    graph.run(thread_pool);
+    ASSERT_EQ(x, 1);
+}
+
+TEST_F(TaskGraphTest, Chain) {
+    spindle::TaskGraph graph;
+    std::vector<int> order;
+    spindle::TaskGraph::NodeId prev = graph.add([&order] { order.push_back(0); });
+    for (int i = 1; i < 100; ++i) {
+        prev = graph.add([&order, i] { order.push_back(i); }, {prev});
+    }
+
+    graph.run(thread_pool);
+
+    ASSERT_EQ(order.size(), 100);
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_EQ(order[i], i);
+    }
+}
+
+TEST_F(TaskGraphTest, Diamond) {
+    spindle::TaskGraph graph;
+    std::atomic_int a{0};
+    std::atomic_int b{0};
+    std::atomic_int c{0};
+    int sum = 0;
+    auto top = graph.add([&] { a = 1; });
+    auto left = graph.add([&] { b = a + 1; }, {top});
+    auto right = graph.add([&] { c = a + 2; }, {top});
+    graph.add([&] { sum = b + c; }, {left, right});
+
+    graph.run(thread_pool);
+    ASSERT_EQ(sum, 5);
+}
+
+TEST_F(TaskGraphTest, WideGraph) {
+    constexpr int width = 1000;
+    spindle::TaskGraph graph;
+    std::atomic_int count{0};
+    int seen = 0;
+    auto source = graph.add(nullptr);
+    auto sink = graph.add([&] { seen = count; });
+    for (int i = 0; i < width; ++i) {
+        auto node = graph.add([&count] { count++; }, {source});
+        graph.add_dependency(sink, node);
+    }
+
+    graph.run(thread_pool);
+    ASSERT_EQ(seen, width);
+}
+
+TEST_F(TaskGraphTest, MultipleRoots) {
+    spindle::TaskGraph graph;
+    std::atomic_int count{0};
+    std::vector<spindle::TaskGraph::NodeId> roots;
+    for (int i = 0; i < 16; ++i) {
+        roots.push_back(graph.add([&count] { count++; }));
+    }
+    int seen = 0;
+    auto sink = graph.add([&] { seen = count; });
+    for (auto root : roots) {
+        graph.add_dependency(sink, root);
+    }
+
+    graph.run(thread_pool);
+    ASSERT_EQ(seen, 16);
+}
+
+TEST_F(TaskGraphTest, RunRepeatedly) {
+    spindle::TaskGraph graph;
+    std::atomic_int count{0};
+    auto first = graph.add([&count] { count++; });
+    graph.add([&count] { count++; }, {first});
+    graph.add([&count] { count++; }, {first});
+
+    for (int i = 0; i < 100; ++i) {
+        graph.run(thread_pool);
+    }
+    ASSERT_EQ(count, 300);
+}
+
+TEST_F(TaskGraphTest, AddAfterRun) {
+    spindle::TaskGraph graph;
+    std::vector<int> order;
+    auto first = graph.add([&order] { order.push_back(1); });
+    graph.run(thread_pool);
+
+    graph.add([&order] { order.push_back(2); }, {first});
+    graph.run(thread_pool);
+
+    ASSERT_EQ(order, (std::vector<int>{1, 1, 2}));
+}
+
+TEST_F(TaskGraphTest, Cycle) {
+    spindle::TaskGraph graph;
+    auto a = graph.add(nullptr);
+    auto b = graph.add(nullptr, {a});
+    auto c = graph.add(nullptr, {b});
+    graph.add_dependency(a, c);
+    EXPECT_THROW(graph.run(thread_pool), std::runtime_error);
+}
+
+TEST_F(TaskGraphTest, InvalidNode) {
+    spindle::TaskGraph graph;
+    auto a = graph.add(nullptr);
+    EXPECT_THROW(graph.add(nullptr, {a + 1}), std::runtime_error);
+    EXPECT_THROW(graph.add_dependency(a, a + 1), std::runtime_error);
+    EXPECT_THROW(graph.add_dependency(a, a), std::runtime_error);
+    ASSERT_EQ(graph.size(), 1);
+}
+
+TEST_F(TaskGraphTest, Exception) {
+    spindle::TaskGraph graph;
+    bool ran = false;
+    auto a = graph.add([] { throw std::runtime_error{"failed"}; });
+    graph.add([&ran] { ran = true; }, {a});
+
+    EXPECT_THROW(graph.run(thread_pool), std::runtime_error);
+    ASSERT_FALSE(ran);
+}
+
+TEST_F(TaskGraphTest, RunFromPoolThread) {
+    spindle::TaskGraph graph;
+    std::atomic_int count{0};
+    auto source = graph.add(nullptr);
+    for (int i = 0; i < 64; ++i) {
+        graph.add([&count] { count++; }, {source});
+    }
+
+    std::promise<void> done;
+    thread_pool.execute([&] {
+        graph.run(thread_pool);
+        done.set_value();
+    });
+    done.get_future().get();
+    ASSERT_EQ(count, 64);
+}
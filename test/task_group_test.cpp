@@ -0,0 +1,163 @@
+#include "spindle/task_group.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "spindle/thread_pool.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+uint64_t fib(spindle::ThreadPool& pool, uint32_t n) {
+    if (n < 2) return n;
+    uint64_t a;
+    uint64_t b;
+    spindle::TaskGroup group{pool};
+    group.run([&] { a = fib(pool, n - 1); });
+    group.run_and_wait([&] { b = fib(pool, n - 2); });
+    return a + b;
+}
+
+void quicksort(spindle::ThreadPool& pool, int* first, int* last) {
+    if (last - first < 32) {
+        std::sort(first, last);
+        return;
+    }
+    int pivot = first[(last - first) / 2];
+    int* mid1 = std::partition(first, last, [pivot](int x) { return x < pivot; });
+    int* mid2 = std::partition(mid1, last, [pivot](int x) { return !(pivot < x); });
+    spindle::TaskGroup group{pool};
+    group.run([&] { quicksort(pool, first, mid1); });
+    group.run_and_wait([&] { quicksort(pool, mid2, last); });
+}
+
+} // namespace
+
+class TaskGroupTest : public testing::Test {
+  protected:
+    spindle::ThreadPool thread_pool{4};
+};
+
+TEST_F(TaskGroupTest, RunAndWait) {
+    spindle::TaskGroup group{thread_pool};
+    std::atomic_int count{0};
+    for (int i = 0; i < 1000; ++i) {
+        group.run([&count] { count++; });
+    }
+    group.wait();
+    ASSERT_EQ(count, 1000);
+}
+
+TEST_F(TaskGroupTest, WaitWithoutTasks) {
+    spindle::TaskGroup group{thread_pool};
+    group.wait();
+}
+
+TEST_F(TaskGroupTest, Reuse) {
+    spindle::TaskGroup group{thread_pool};
+    std::atomic_int count{0};
+    for (int round = 1; round <= 10; ++round) {
+        for (int i = 0; i < 10; ++i) {
+            group.run([&count] { count++; });
+        }
+        group.wait();
+        ASSERT_EQ(count, round * 10);
+    }
+}
+
+TEST_F(TaskGroupTest, MoveOnlyTask) {
+    spindle::TaskGroup group{thread_pool};
+    int x = 0;
+    auto p = std::make_unique<int>(42);
+    group.run([&x, p = std::move(p)] { x = *p; });
+    group.wait();
+    ASSERT_EQ(x, 42);
+}
+
+TEST_F(TaskGroupTest, Exception) {
+    spindle::TaskGroup group{thread_pool};
+    group.run([] { throw std::runtime_error{"failed"}; });
+    EXPECT_THROW(group.wait(), std::runtime_error);
+
+    // The group is usable again once the exception has been rethrown.
+    ASSERT_FALSE(group.is_cancelled());
+    int x = 0;
+    group.run([&x] { x = 1; });
+    group.wait();
+    ASSERT_EQ(x, 1);
+}
+
+TEST_F(TaskGroupTest, ExceptionFromRunAndWait) {
+    spindle::TaskGroup group{thread_pool};
+    std::atomic_int count{0};
+    group.run([&count] { count++; });
+    EXPECT_THROW(group.run_and_wait([] { throw std::runtime_error{"failed"}; }),
+                 std::runtime_error);
+    ASSERT_LE(count, 1);
+}
+
+TEST_F(TaskGroupTest, Cancel) {
+    spindle::TaskGroup group{thread_pool};
+    std::atomic_int count{0};
+    group.cancel();
+    for (int i = 0; i < 100; ++i) {
+        group.run([&count] { count++; });
+    }
+    group.wait();
+    ASSERT_EQ(count, 0);
+    ASSERT_FALSE(group.is_cancelled());
+}
+
+TEST_F(TaskGroupTest, DestructorWaits) {
+    std::atomic_int count{0};
+    {
+        spindle::TaskGroup group{thread_pool};
+        for (int i = 0; i < 8; ++i) {
+            group.run([&count] {
+                std::this_thread::sleep_for(std::chrono::milliseconds{5});
+                count++;
+            });
+        }
+    }
+    ASSERT_EQ(count, 8);
+}
+
+TEST_F(TaskGroupTest, RejectedTask) {
+    spindle::ThreadPool pool{2};
+    pool.drain();
+    spindle::TaskGroup group{pool};
+    group.run([] {});
+    EXPECT_THROW(group.wait(), std::future_error);
+}
+
+TEST_F(TaskGroupTest, NestedFib) {
+    // Every level of the recursion waits on a group, which would exhaust the threads of the pool if
+    // waiting blocked them.
+    spindle::ThreadPool pool{2};
+    ASSERT_EQ(fib(pool, 20), 6765);
+}
+
+TEST_F(TaskGroupTest, NestedFromPoolThread) {
+    std::promise<uint64_t> result;
+    thread_pool.execute([&] { result.set_value(fib(thread_pool, 18)); });
+    ASSERT_EQ(result.get_future().get(), 2584);
+}
+
+TEST_F(TaskGroupTest, Quicksort) {
+    std::vector<int> v(100'000);
+    std::minstd_rand rng{42};
+    for (int& x : v) {
+        x = rng() % 1000;
+    }
+
+    quicksort(thread_pool, v.data(), v.data() + v.size());
+    ASSERT_TRUE(std::is_sorted(v.begin(), v.end()));
+}
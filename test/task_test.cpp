@@ -0,0 +1,82 @@
+#include "spindle/task.h"
+
+#include <array>
+#include <memory>
+
+#include "gtest/gtest.h"
+
+TEST(Task, Empty) {
+    spindle::Task task;
+    ASSERT_EQ(static_cast<bool>(task), false);
+    EXPECT_THROW(task(), std::bad_function_call);
+
+    spindle::Task null_task{nullptr};
+    ASSERT_EQ(static_cast<bool>(null_task), false);
+}
+
+TEST(Task, InlineCallable) {
+    int x = 0;
+    spindle::Task task{[&x] { x++; }};
+    ASSERT_EQ(static_cast<bool>(task), true);
+
+    task();
+    task();
+    ASSERT_EQ(x, 2);
+}
+
+TEST(Task, LargeCallable) {
+    std::array<int, 64> values{};
+    values[63] = 42;
+    int x = 0;
+    spindle::Task task{[values, &x] { x = values[63]; }};
+
+    spindle::Task moved{std::move(task)};
+    moved();
+    ASSERT_EQ(x, 42);
+}
+
+TEST(Task, MoveOnlyCapture) {
+    int x = 0;
+    auto value = std::make_unique<int>(7);
+    spindle::Task task{[&x, value = std::move(value)] { x = *value; }};
+
+    task();
+    ASSERT_EQ(x, 7);
+}
+
+TEST(Task, MoveLeavesSourceEmpty) {
+    int x = 0;
+    spindle::Task task{[&x] { x++; }};
+    spindle::Task other;
+
+    other = std::move(task);
+    ASSERT_EQ(static_cast<bool>(task), false);
+    ASSERT_EQ(static_cast<bool>(other), true);
+
+    other();
+    ASSERT_EQ(x, 1);
+}
+
+TEST(Task, DestroysCallable) {
+    auto inline_ref = std::make_shared<int>();
+    auto heap_ref = std::make_shared<int>();
+    std::array<char, 2 * spindle::Task::inline_size> padding{};
+
+    {
+        spindle::Task inline_task{[inline_ref] {}};
+        spindle::Task heap_task{[heap_ref, padding] {}};
+        ASSERT_EQ(inline_ref.use_count(), 2);
+        ASSERT_EQ(heap_ref.use_count(), 2);
+
+        // Moving transfers ownership without copying.
+        spindle::Task inline_moved{std::move(inline_task)};
+        spindle::Task heap_moved{std::move(heap_task)};
+        ASSERT_EQ(inline_ref.use_count(), 2);
+        ASSERT_EQ(heap_ref.use_count(), 2);
+
+        inline_moved = nullptr;
+        ASSERT_EQ(inline_ref.use_count(), 1);
+    }
+
+    ASSERT_EQ(heap_ref.use_count(), 1);
+}
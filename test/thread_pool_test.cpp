@@ -1,8 +1,17 @@
 #include "spindle/thread_pool.h"
 
+#include <pthread.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <sstream>
+#include <string>
 #include <thread>
 #include <vector>
 
+#include "spindle/barrier.h"
 #include "spindle/latch.h"
 
 #include "gtest/gtest.h"
@@ -133,3 +142,527 @@ TEST_F(ThreadPoolTest, MultipleThreadsManyTasksRecursiveSchedule) {
         }
     }
 }
+
+TEST_F(ThreadPoolTest, IdleThreadsStealFromBusyThread) {
+    uint32_t task_count = 64;
+    spindle::ThreadPool pool{2};
+    spindle::Latch release{};
+    spindle::Latch done{task_count};
+
+    // The first task occupies one of the threads until every other task has run. Half of the
+    // remaining tasks are queued behind it, so they can only run if the idle thread steals them.
+    pool.execute([&] { release.wait(); });
+    for (int i = 0; i < task_count; ++i) {
+        pool.execute([&] { done.decrement(); });
+    }
+
+    done.wait();
+    release.decrement();
+    pool.drain();
+}
+
+TEST_F(ThreadPoolTest, WaitStrategies) {
+    for (spindle::WaitStrategy strategy :
+         {spindle::WaitStrategy::park, spindle::WaitStrategy::adaptive,
+          spindle::WaitStrategy::spin}) {
+        spindle::ThreadPoolOptions options;
+        options.num_threads = 2;
+        options.wait_strategy = strategy;
+        spindle::ThreadPool pool{options};
+        // Each task is scheduled after the previous one has run, so the threads run out of work
+        // and wait in between.
+        for (int i = 0; i < 256; ++i) {
+            spindle::Latch latch{};
+            pool.execute([&latch] { latch.decrement(); });
+            latch.wait();
+        }
+        pool.drain();
+    }
+}
+
+TEST_F(ThreadPoolTest, ExecuteOn) {
+    uint32_t task_count = 64;
+    spindle::ThreadPool placed{4};
+    std::vector<std::thread::id> thread_ids(placed.size());
+    spindle::Latch started{placed.size()};
+    for (uint32_t i = 0; i < placed.size(); ++i) {
+        placed.execute_on(i, [&, i] {
+            thread_ids[i] = std::this_thread::get_id();
+            started.decrement();
+        });
+    }
+    started.wait();
+
+    // Pinned tasks are never stolen, even while their thread is busy.
+    std::vector<std::thread::id> ran_on(task_count);
+    spindle::Latch done{task_count};
+    for (uint32_t i = 0; i < task_count; ++i) {
+        placed.execute_on(i % placed.size(), [&, i] {
+            ran_on[i] = std::this_thread::get_id();
+            done.decrement();
+        });
+    }
+    done.wait();
+    for (uint32_t i = 0; i < task_count; ++i) {
+        ASSERT_EQ(ran_on[i], thread_ids[i % placed.size()]);
+    }
+    placed.drain();
+
+    EXPECT_THROW(placed.execute_on(placed.size(), [] {}), std::runtime_error);
+}
+
+TEST_F(ThreadPoolTest, Options) {
+    spindle::ThreadPoolOptions options;
+    options.num_threads = 2;
+    options.thread_name = "options-test";
+    options.stack_size = 1 << 20;
+    options.cpu_affinity = {{0}};
+    spindle::ThreadPool pool{options};
+
+    std::vector<std::string> names(pool.size());
+    for (uint32_t i = 0; i < pool.size(); ++i) {
+        pool.execute_on(i, [&names, i] {
+            char name[16] = {};
+            pthread_getname_np(pthread_self(), name, sizeof(name));
+            names[i] = name;
+        });
+    }
+    pool.drain();
+
+#if defined(__linux__) || defined(__APPLE__)
+    EXPECT_EQ(names[0], "options-test-0");
+    EXPECT_EQ(names[1], "options-test-1");
+#endif
+}
+
+TEST_F(ThreadPoolTest, NumaAware) {
+    spindle::ThreadPoolOptions options;
+    options.num_threads = 4;
+    options.numa_aware = true;
+    spindle::ThreadPool pool{options};
+
+    std::atomic_int x{};
+    for (int i = 0; i < 256; ++i) {
+        pool.execute([&x] { x++; });
+    }
+    pool.drain();
+    ASSERT_EQ(x, 256);
+}
+
+TEST_F(ThreadPoolTest, InvalidOptions) {
+    spindle::ThreadPoolOptions options;
+    options.num_threads = 1;
+    options.cpu_affinity = {{0}, {0}};
+    EXPECT_THROW(spindle::ThreadPool{options}, std::runtime_error);
+
+#if defined(__linux__)
+    options.cpu_affinity = {{1 << 20}};
+    EXPECT_THROW(spindle::ThreadPool{options}, std::runtime_error);
+#endif
+}
+
+TEST_F(ThreadPoolTest, CriticalTaskOvertakesBackground) {
+    uint32_t task_count = 256;
+    spindle::ThreadPool pool{1};
+    spindle::Latch release{};
+    std::atomic_int ran{};
+    int critical_ran_after = -1;
+
+    // The thread is busy while the tasks are queued, so the critical task is queued last.
+    pool.execute([&] { release.wait(); });
+    for (int i = 0; i < task_count; ++i) {
+        pool.execute([&] { ran++; }, spindle::Priority::background);
+    }
+    pool.execute([&] { critical_ran_after = ran; }, spindle::Priority::critical);
+    release.decrement();
+    pool.drain();
+
+    ASSERT_EQ(ran, task_count);
+    ASSERT_LT(critical_ran_after, 16);
+    ASSERT_EQ(pool.queueing_delay(spindle::Priority::background).tasks, task_count);
+    ASSERT_EQ(pool.queueing_delay(spindle::Priority::critical).tasks, 1);
+    ASSERT_EQ(pool.queueing_delay(spindle::Priority::normal).tasks, 1);
+}
+
+TEST_F(ThreadPoolTest, CancelTasks) {
+    spindle::ThreadPool pool{1};
+    spindle::Latch release{};
+    std::atomic_int ran{};
+
+    // The thread is busy while the tasks are queued and cancelled.
+    pool.execute([&] { release.wait(); });
+    spindle::TaskHandle immediate = pool.execute_cancellable([&] { ran++; });
+    spindle::TaskHandle deferred = pool.execute_after([&] { ran++; }, std::chrono::milliseconds{1});
+    spindle::TaskHandle kept = pool.execute_cancellable([&] { ran++; });
+    ASSERT_EQ(immediate.cancel(), true);
+    ASSERT_EQ(deferred.cancel(), true);
+    release.decrement();
+    pool.drain();
+
+    ASSERT_EQ(ran, 1);
+    ASSERT_EQ(kept.cancel(), false);
+}
+
+namespace {
+
+// Returns the options of a pool with a single thread, whose queues hold two tasks each.
+spindle::ThreadPoolOptions bounded(spindle::OverflowPolicy policy) {
+    spindle::ThreadPoolOptions options;
+    options.num_threads = 1;
+    options.queue_capacity = 2;
+    options.overflow_policy = policy;
+    return options;
+}
+
+// Occupies the thread of `pool` until `release` is decremented, so that its queues fill up.
+void occupy(spindle::ThreadPool& pool, spindle::Latch& release) {
+    spindle::Latch started{};
+    pool.execute([&] {
+        started.decrement();
+        release.wait();
+    });
+    started.wait();
+}
+
+} // namespace
+
+TEST_F(ThreadPoolTest, TryExecute) {
+    spindle::ThreadPool pool{bounded(spindle::OverflowPolicy::block)};
+    spindle::Latch release{};
+    std::atomic_int ran{};
+    occupy(pool, release);
+
+    ASSERT_TRUE(pool.try_execute([&] { ran++; }));
+    ASSERT_TRUE(pool.try_execute([&] { ran++; }));
+    spindle::Task task{[&] { ran++; }};
+    ASSERT_FALSE(pool.try_execute(std::move(task)));
+    ASSERT_TRUE(static_cast<bool>(task));
+    // Other priority classes have queues of their own.
+    ASSERT_TRUE(pool.try_execute([&] { ran++; }, spindle::Priority::critical));
+
+    spindle::Metrics metrics = pool.metrics();
+    ASSERT_EQ(metrics.queue_capacity, 2);
+    ASSERT_EQ(metrics.workers[0].queue_depth[static_cast<size_t>(spindle::Priority::normal)], 2);
+    ASSERT_EQ(metrics.workers[0].queued, 3);
+    ASSERT_EQ(metrics.workers[0].overflowed, 0);
+
+    release.decrement();
+    pool.drain();
+    ASSERT_EQ(ran, 3);
+    ASSERT_FALSE(pool.try_execute([] {}));
+}
+
+TEST_F(ThreadPoolTest, OverflowBlocks) {
+    spindle::ThreadPool pool{bounded(spindle::OverflowPolicy::block)};
+    spindle::Latch release{};
+    std::atomic_int ran{};
+    occupy(pool, release);
+
+    pool.execute([&] { ran++; });
+    pool.execute([&] { ran++; });
+    std::atomic_bool queued{};
+    std::thread producer{[&] {
+        pool.execute([&] { ran++; });
+        queued = true;
+    }};
+    std::this_thread::sleep_for(std::chrono::milliseconds{20});
+    ASSERT_FALSE(queued);
+
+    release.decrement();
+    producer.join();
+    pool.drain();
+    ASSERT_EQ(ran, 3);
+    ASSERT_EQ(pool.metrics().workers[0].overflowed, 1);
+}
+
+TEST_F(ThreadPoolTest, OverflowDoesNotBlockOwnThread) {
+    spindle::ThreadPool pool{bounded(spindle::OverflowPolicy::block)};
+    spindle::Latch done{};
+    bool ran_inline = false;
+    pool.execute([&] {
+        pool.execute([] {});
+        pool.execute([] {});
+        // The queue of this thread is full, so the task runs here instead of waiting on itself.
+        std::thread::id self = std::this_thread::get_id();
+        pool.execute([&] { ran_inline = std::this_thread::get_id() == self; });
+        done.decrement();
+    });
+    done.wait();
+    pool.drain();
+    ASSERT_TRUE(ran_inline);
+}
+
+TEST_F(ThreadPoolTest, OverflowRunsInCaller) {
+    spindle::ThreadPool pool{bounded(spindle::OverflowPolicy::caller_runs)};
+    spindle::Latch release{};
+    occupy(pool, release);
+
+    pool.execute([] {});
+    pool.execute([] {});
+    std::thread::id ran_on;
+    pool.execute([&] { ran_on = std::this_thread::get_id(); });
+    ASSERT_EQ(ran_on, std::this_thread::get_id());
+
+    release.decrement();
+    pool.drain();
+}
+
+TEST_F(ThreadPoolTest, OverflowDropsOldest) {
+    spindle::ThreadPool pool{bounded(spindle::OverflowPolicy::drop_oldest)};
+    spindle::Latch release{};
+    std::vector<int> ran;
+    occupy(pool, release);
+
+    for (int i = 0; i < 4; ++i) {
+        pool.execute([&, i] { ran.push_back(i); });
+    }
+    release.decrement();
+    pool.drain();
+
+    ASSERT_EQ(ran, (std::vector<int>{2, 3}));
+    spindle::Metrics metrics = pool.metrics();
+    ASSERT_EQ(metrics.workers[0].overflowed, 2);
+    ASSERT_EQ(metrics.workers[0].dropped, 2);
+}
+
+TEST_F(ThreadPoolTest, TwoChoicesDispatch) {
+    spindle::ThreadPoolOptions options;
+    options.num_threads = 2;
+    options.dispatch_policy = spindle::DispatchPolicy::two_choices;
+    spindle::ThreadPool pool{options};
+    spindle::Latch started{2};
+    spindle::Latch release{};
+    for (uint32_t i = 0; i < 2; ++i) {
+        pool.execute_on(i, [&] {
+            started.decrement();
+            release.wait();
+        });
+    }
+    started.wait();
+
+    // Both threads are busy, and each task goes to the one with the shorter queue.
+    std::atomic_int ran{};
+    for (int i = 0; i < 20; ++i) {
+        pool.execute([&] { ran++; });
+    }
+    spindle::Metrics metrics = pool.metrics();
+    for (const spindle::WorkerMetrics& worker : metrics.workers) {
+        ASSERT_EQ(worker.queue_depth[static_cast<size_t>(spindle::Priority::normal)], 10);
+    }
+
+    release.decrement();
+    pool.drain();
+    ASSERT_EQ(ran, 20);
+}
+
+TEST_F(ThreadPoolTest, ScheduleOnTimerThread) {
+    spindle::ThreadPool pool{2};
+    spindle::Latch release{};
+    spindle::Latch done{};
+    std::atomic_int ran{};
+
+    // The first thread is busy, so due tasks run on the second one.
+    pool.execute_on(0, [&] { release.wait(); });
+    pool.schedule_after([&] { ran++; }, std::chrono::milliseconds{1});
+    spindle::TaskHandle periodic = pool.schedule_at_fixed_rate(
+        [&] {
+            if (++ran == 4) done.decrement();
+        },
+        std::chrono::milliseconds{1},
+        std::chrono::milliseconds{1});
+    done.wait();
+    ASSERT_EQ(periodic.cancel(), true);
+    release.decrement();
+
+    // Periodic tasks stop when the pool drains.
+    pool.schedule_with_fixed_delay(
+        [&] { ran++; }, std::chrono::milliseconds{50}, std::chrono::milliseconds{1});
+    pool.drain();
+    ASSERT_GE(ran, 4);
+    ASSERT_EQ(static_cast<bool>(pool.schedule_after([] {}, {})), false);
+}
+
+TEST_F(ThreadPoolTest, Metrics) {
+    uint32_t task_count = 64;
+    spindle::ThreadPool pool{2};
+    for (uint32_t i = 0; i < task_count; ++i) {
+        pool.execute([] {}, spindle::Priority::background);
+    }
+    pool.execute_after([] {}, std::chrono::milliseconds{1});
+    pool.drain();
+
+    spindle::Metrics metrics = pool.metrics();
+    ASSERT_EQ(metrics.threads, 2);
+    ASSERT_EQ(metrics.workers.size(), 2);
+    uint64_t executed = 0;
+    for (const spindle::WorkerMetrics& worker : metrics.workers) {
+        ASSERT_EQ(worker.queued, 0);
+        ASSERT_EQ(worker.deferred, 0);
+        executed += worker.executed;
+    }
+    ASSERT_EQ(executed, task_count + 1);
+    ASSERT_EQ(metrics.queueing_delay(spindle::Priority::background).count(), task_count);
+    ASSERT_EQ(metrics.queueing_delay(spindle::Priority::critical).count(), 0);
+    ASSERT_NE(metrics.to_prometheus().find("spindle_tasks_executed_total{worker=\"1\"}"),
+              std::string::npos);
+}
+
+TEST_F(ThreadPoolTest, Tracing) {
+#if !SPINDLE_TRACING
+    GTEST_SKIP();
+#endif
+    spindle::ThreadPoolOptions options;
+    options.num_threads = 2;
+    options.trace_capacity = 16;
+    spindle::ThreadPool pool{options};
+    for (int i = 0; i < 32; ++i) {
+        pool.execute([] {});
+    }
+    pool.execute_on(1, [] {});
+    pool.execute_after([] {}, std::chrono::milliseconds{1});
+    pool.drain();
+
+    std::stringstream out;
+    pool.write_trace(out);
+    std::string trace = out.str();
+    EXPECT_NE(trace.find("\"name\":\"spindle-1\""), std::string::npos);
+    EXPECT_NE(trace.find("{\"name\":\"normal\""), std::string::npos);
+    EXPECT_NE(trace.find("{\"name\":\"pinned\",\"cat\":\"task\",\"ph\":\"X\",\"pid\":1,\"tid\":1"),
+              std::string::npos);
+    EXPECT_NE(trace.find("{\"name\":\"deferred\""), std::string::npos);
+}
+
+TEST_F(ThreadPoolTest, ElasticPoolStartsLazily) {
+    spindle::ThreadPoolOptions options;
+    options.num_threads = 4;
+    options.min_threads = 0;
+    spindle::ThreadPool pool{options};
+    ASSERT_EQ(pool.num_threads(), 0);
+
+    ASSERT_EQ(pool.submit([] { return 1; }).get(), 1);
+    ASSERT_GE(pool.num_threads(), 1);
+
+    // Placing a task on a worker starts its thread.
+    ASSERT_EQ(pool.submit([] { return 2; }).get(), 2);
+    spindle::Latch latch{};
+    pool.execute_on(3, [&latch] { latch.decrement(); });
+    latch.wait();
+    ASSERT_EQ(pool.num_threads(), 4);
+    pool.drain();
+}
+
+TEST_F(ThreadPoolTest, ElasticPoolGrowsAndShrinks) {
+    uint32_t num_threads = 4;
+    spindle::ThreadPoolOptions options;
+    options.num_threads = num_threads;
+    options.min_threads = 1;
+    options.idle_timeout = std::chrono::milliseconds{10};
+    spindle::ThreadPool pool{options};
+    ASSERT_EQ(pool.num_threads(), 1);
+
+    for (int round = 0; round < 2; ++round) {
+        // The tasks only complete once all of them run at the same time, which takes every thread.
+        spindle::Barrier barrier{num_threads};
+        spindle::Latch done{num_threads};
+        for (uint32_t i = 0; i < num_threads; ++i) {
+            pool.execute([&] {
+                barrier.arrive_and_wait();
+                done.decrement();
+            });
+        }
+        done.wait();
+        ASSERT_EQ(pool.num_threads(), num_threads);
+
+        // Surplus threads retire once idle.
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{5};
+        while (pool.num_threads() > 1 && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds{1});
+        }
+        ASSERT_EQ(pool.num_threads(), 1);
+    }
+
+    std::atomic_int x{};
+    for (int i = 0; i < 256; ++i) {
+        pool.execute([&x] { x++; });
+    }
+    pool.drain();
+    ASSERT_EQ(x, 256);
+}
+
+TEST_F(ThreadPoolTest, DefaultPool) {
+    spindle::ThreadPool& pool = spindle::ThreadPool::default_pool();
+    ASSERT_EQ(&pool, &spindle::ThreadPool::default_pool());
+    ASSERT_EQ(pool.submit([] { return 3; }).get(), 3);
+    ASSERT_GE(pool.num_threads(), 1);
+}
+
+TEST_F(ThreadPoolTest, MoveOnlyCapture) {
+    int x = 0;
+    auto value = std::make_unique<int>(42);
+
+    thread_pool.execute([&x, value = std::move(value)] { x = *value; });
+
+    thread_pool.drain();
+    ASSERT_EQ(x, 42);
+}
+
+TEST_F(ThreadPoolTest, ExecuteBulk) {
+    uint32_t task_count = 4099; // Not a multiple of the number of threads.
+    std::vector<uint32_t> x(task_count);
+    std::vector<spindle::Task> tasks;
+    for (uint32_t i = 0; i < task_count; ++i) {
+        tasks.emplace_back([&x, i] { x[i] = i; });
+    }
+
+    thread_pool.execute_bulk(tasks.data(), tasks.data() + tasks.size());
+    thread_pool.drain();
+
+    for (uint32_t i = 0; i < task_count; ++i) {
+        ASSERT_EQ(x[i], i);
+    }
+}
+
+TEST_F(ThreadPoolTest, ExecuteBulkFewerTasksThanThreads) {
+    uint32_t task_count = 3;
+    spindle::ThreadPool pool{8};
+    std::vector<uint32_t> x(task_count);
+    std::vector<spindle::Task> tasks;
+    for (uint32_t i = 0; i < task_count; ++i) {
+        tasks.emplace_back([&x, i] { x[i] = i + 1; });
+    }
+
+    pool.execute_bulk(tasks.data(), tasks.data() + tasks.size());
+    pool.drain();
+
+    for (uint32_t i = 0; i < task_count; ++i) {
+        ASSERT_EQ(x[i], i + 1);
+    }
+}
+
+TEST_F(ThreadPoolTest, ExecuteBulkFromIterators) {
+    uint32_t task_count = 256;
+    std::atomic_int x{};
+    std::vector<std::function<void()>> funcs(task_count, [&x] { x++; });
+
+    thread_pool.execute_bulk(funcs.begin(), funcs.end());
+    thread_pool.drain();
+
+    ASSERT_EQ(x, task_count);
+}
+
+TEST_F(ThreadPoolTest, ExecuteAfter) {
+    using clock = std::chrono::steady_clock;
+    clock::time_point start = clock::now();
+    clock::time_point ran;
+    spindle::Latch latch;
+
+    thread_pool.execute_after(
+        [&] {
+            ran = clock::now();
+            latch.decrement();
+        },
+        std::chrono::milliseconds{20});
+
+    latch.wait();
+    ASSERT_GE(ran - start, std::chrono::milliseconds{20});
+}
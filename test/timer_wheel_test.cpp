@@ -0,0 +1,168 @@
+#include "timer_wheel.h"
+
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+class TimerWheelTest : public ::testing::Test {
+  protected:
+    using ms = std::chrono::milliseconds;
+
+    void insert(spindle::clock::duration offset, int id) {
+        wheel.insert({[this, id] { fired.push_back(id); }, origin + offset, {}, false});
+    }
+
+    // Advances simulated time from one deadline to the next until the wheel is empty, checking that
+    // no timer fires early or more than one tick late.
+    void run_to_completion() {
+        spindle::Timer timer;
+        while (!wheel.empty()) {
+            spindle::clock::time_point now = wheel.next_deadline();
+            ASSERT_NE(now, spindle::clock::time_point::max());
+            // Nothing is due just before the next deadline.
+            ASSERT_EQ(wheel.poll(now - spindle::clock::duration{1}, timer), false);
+            while (wheel.poll(now, timer)) {
+                ASSERT_GE(now, timer.deadline);
+                ASSERT_LT(now - timer.deadline, resolution);
+                timer.func();
+            }
+        }
+    }
+
+    spindle::clock::duration resolution = ms{1};
+    spindle::clock::time_point origin = spindle::clock::now();
+    spindle::TimerWheel wheel{resolution, origin};
+    std::vector<int> fired;
+};
+
+TEST_F(TimerWheelTest, InvalidResolution) {
+    EXPECT_THROW(spindle::TimerWheel{spindle::clock::duration::zero()}, std::runtime_error);
+}
+
+TEST_F(TimerWheelTest, Empty) {
+    spindle::Timer timer;
+    ASSERT_EQ(wheel.empty(), true);
+    ASSERT_EQ(wheel.next_deadline(), spindle::clock::time_point::max());
+    ASSERT_EQ(wheel.poll(origin + std::chrono::hours{1}, timer), false);
+}
+
+TEST_F(TimerWheelTest, FireInDeadlineOrder) {
+    // Spans all levels of the wheel.
+    insert(ms{5'000'000}, 6);
+    insert(ms{70}, 3);
+    insert(ms{1}, 1);
+    insert(ms{300'000}, 5);
+    insert(ms{5}, 2);
+    insert(ms{4'100}, 4);
+    ASSERT_EQ(wheel.size(), 6);
+
+    run_to_completion();
+    ASSERT_EQ(fired, (std::vector<int>{1, 2, 3, 4, 5, 6}));
+}
+
+TEST_F(TimerWheelTest, SameTickInInsertionOrder) {
+    for (int i = 0; i < 8; ++i) {
+        insert(ms{200}, i);
+    }
+
+    run_to_completion();
+    ASSERT_EQ(fired, (std::vector<int>{0, 1, 2, 3, 4, 5, 6, 7}));
+}
+
+TEST_F(TimerWheelTest, OverdueTimer) {
+    spindle::Timer timer;
+    spindle::clock::time_point now = origin + ms{100};
+    ASSERT_EQ(wheel.poll(now, timer), false);
+
+    insert(ms{10}, 1);
+    ASSERT_LE(wheel.next_deadline(), now);
+    ASSERT_EQ(wheel.poll(now, timer), true);
+    ASSERT_EQ(wheel.empty(), true);
+}
+
+TEST_F(TimerWheelTest, InsertWhileAdvancing) {
+    spindle::Timer timer;
+    insert(ms{100}, 1);
+    ASSERT_EQ(wheel.poll(origin + ms{100}, timer), true);
+
+    // Timers inserted after the wheel has advanced are relative to the same origin.
+    insert(ms{150}, 2);
+    insert(ms{120}, 3);
+    run_to_completion();
+    ASSERT_EQ(fired, (std::vector<int>{3, 2}));
+}
+
+TEST_F(TimerWheelTest, RemoveIf) {
+    // Timers at 1ms, 5ms and 5s, which are respectively expired, in the lowest level and in a
+    // higher level once the wheel advances to 1ms.
+    const ms offsets[] = {ms{1}, ms{5}, ms{5'000}};
+    std::vector<std::shared_ptr<spindle::detail::CancelState>> cancels;
+    insert(ms{1}, 6);
+    for (int i = 0; i < 6; ++i) {
+        cancels.push_back(std::make_shared<spindle::detail::CancelState>());
+        wheel.insert(
+            {[this, i] { fired.push_back(i); }, origin + offsets[i % 3], {}, false, cancels[i]});
+    }
+    spindle::Timer timer;
+    ASSERT_EQ(wheel.poll(origin + ms{1}, timer), true);
+
+    cancels[0]->cancel();
+    cancels[1]->cancel();
+    cancels[5]->cancel();
+    auto cancelled = [](const spindle::Timer& timer) {
+        return timer.cancel != nullptr && timer.cancel->cancelled();
+    };
+    ASSERT_EQ(wheel.remove_if(cancelled), 3);
+    ASSERT_EQ(wheel.size(), 3);
+    ASSERT_EQ(wheel.remove_if(cancelled), 0);
+
+    while (wheel.poll(origin + ms{5'000}, timer)) {
+        timer.func();
+    }
+    ASSERT_EQ(wheel.empty(), true);
+    ASSERT_EQ(fired, (std::vector<int>{3, 4, 2}));
+}
+
+TEST_F(TimerWheelTest, BeyondTopLevel) {
+    resolution = std::chrono::nanoseconds{1};
+    spindle::TimerWheel fine_wheel{resolution, origin};
+    spindle::Timer timer;
+
+    // 2^40 ticks is well beyond the span of the top level.
+    spindle::clock::time_point deadline = origin + std::chrono::nanoseconds{int64_t{1} << 40};
+    fine_wheel.insert({[] {}, deadline, {}, false});
+
+    spindle::clock::time_point now = origin;
+    while (!fine_wheel.poll(now, timer)) {
+        now = fine_wheel.next_deadline();
+        ASSERT_LE(now, deadline);
+    }
+    ASSERT_EQ(now, deadline);
+}
+
+TEST_F(TimerWheelTest, RandomDeadlines) {
+    std::mt19937_64 rng{42};
+    std::uniform_int_distribution<int64_t> dist{0, int64_t{1} << 32};
+    std::vector<spindle::clock::time_point> deadlines;
+
+    for (int i = 0; i < 10'000; ++i) {
+        spindle::clock::time_point deadline = origin + std::chrono::microseconds{dist(rng)};
+        deadlines.push_back(deadline);
+        wheel.insert({[] {}, deadline, {}, false});
+    }
+
+    spindle::Timer timer;
+    spindle::clock::time_point last = origin;
+    while (!wheel.empty()) {
+        spindle::clock::time_point now = wheel.next_deadline();
+        while (wheel.poll(now, timer)) {
+            ASSERT_GE(now, timer.deadline);
+            ASSERT_LT(now - timer.deadline, resolution);
+            // Timers come out in order of their tick.
+            ASSERT_GE(timer.deadline + resolution, last);
+            last = timer.deadline;
+        }
+    }
+}
@@ -0,0 +1,30 @@
+#include "topology.h"
+
+#include <stdexcept>
+
+#include "gtest/gtest.h"
+
+TEST(TopologyTest, ParseCpuList) {
+    using spindle::topology::parse_cpu_list;
+    EXPECT_EQ(parse_cpu_list(""), (std::vector<uint32_t>{}));
+    EXPECT_EQ(parse_cpu_list("3"), (std::vector<uint32_t>{3}));
+    EXPECT_EQ(parse_cpu_list("0-3"), (std::vector<uint32_t>{0, 1, 2, 3}));
+    EXPECT_EQ(parse_cpu_list("0-1,8,10-11"), (std::vector<uint32_t>{0, 1, 8, 10, 11}));
+}
+
+TEST(TopologyTest, ParseMalformedCpuList) {
+    using spindle::topology::parse_cpu_list;
+    EXPECT_THROW(parse_cpu_list("a"), std::runtime_error);
+    EXPECT_THROW(parse_cpu_list("1,,2"), std::runtime_error);
+    EXPECT_THROW(parse_cpu_list("3-1"), std::runtime_error);
+    EXPECT_THROW(parse_cpu_list("1-"), std::runtime_error);
+    EXPECT_THROW(parse_cpu_list("12345678901"), std::runtime_error);
+}
+
+TEST(TopologyTest, NumaNodes) {
+    std::vector<std::vector<uint32_t>> nodes = spindle::topology::numa_nodes();
+    ASSERT_FALSE(nodes.empty());
+    for (auto&& cpus : nodes) {
+        EXPECT_FALSE(cpus.empty());
+    }
+}
@@ -0,0 +1,61 @@
+#include "trace.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+spindle::TraceEvent event_at(int64_t us, spindle::TraceKind kind = spindle::TraceKind::normal) {
+    spindle::clock::time_point t{std::chrono::microseconds{us}};
+    return {t - std::chrono::microseconds{1}, t, t + std::chrono::nanoseconds{1500}, kind, false};
+}
+
+} // namespace
+
+TEST(TraceBufferTest, Disabled) {
+    spindle::TraceBuffer buffer;
+    ASSERT_FALSE(buffer.enabled());
+    ASSERT_TRUE(buffer.snapshot().empty());
+}
+
+TEST(TraceBufferTest, KeepsMostRecentEvents) {
+    spindle::TraceBuffer buffer{4};
+    ASSERT_TRUE(buffer.enabled());
+    for (int64_t i = 0; i < 3; ++i) {
+        buffer.record(event_at(i));
+    }
+    ASSERT_EQ(buffer.snapshot().size(), 3);
+
+    for (int64_t i = 3; i < 10; ++i) {
+        buffer.record(event_at(i));
+    }
+    std::vector<spindle::TraceEvent> events = buffer.snapshot();
+    ASSERT_EQ(events.size(), 4);
+    for (int64_t i = 0; i < 4; ++i) {
+        ASSERT_EQ(events[i].start, spindle::clock::time_point{std::chrono::microseconds{6 + i}});
+        ASSERT_EQ(events[i].end - events[i].start, std::chrono::nanoseconds{1500});
+        ASSERT_EQ(events[i].kind, spindle::TraceKind::normal);
+    }
+}
+
+TEST(TraceBufferTest, ChromeTrace) {
+    std::vector<std::vector<spindle::TraceEvent>> threads(2);
+    threads[1].push_back(event_at(42, spindle::TraceKind::critical));
+    threads[1].back().stolen = true;
+
+    std::stringstream out;
+    spindle::write_chrome_trace(out, threads, "pool");
+    std::string trace = out.str();
+    EXPECT_EQ(trace.find("{\"displayTimeUnit\":\"ns\",\"traceEvents\":["), 0);
+    EXPECT_NE(trace.find("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,"
+                         "\"args\":{\"name\":\"pool-0\"}}"),
+              std::string::npos);
+    EXPECT_NE(trace.find("{\"name\":\"critical\",\"cat\":\"task\",\"ph\":\"X\",\"pid\":1,\"tid\":1,"
+                         "\"ts\":42.000,\"dur\":1.500,"
+                         "\"args\":{\"queued_us\":1.000,\"stolen\":true}}"),
+              std::string::npos);
+    EXPECT_EQ(trace.substr(trace.size() - 4), "\n]}\n");
+}
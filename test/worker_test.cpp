@@ -1,5 +1,8 @@
 #include "worker.h"
 
+#include <thread>
+#include <vector>
+
 #include "gtest/gtest.h"
 
 #ifndef SPINDLE_WORKER_DEFERRED_TASK_TESTS_SKIP
@@ -13,12 +16,12 @@ class WorkerTest : public ::testing::Test {
     bool schedule(const std::function<void()>& task, std::chrono::milliseconds delay = {}) {
         terminator.add_task();
         // TODO (whalbawi): Figure out why we need to capture `task` by value rather than reference.
-        return worker.schedule(
+        return static_cast<bool>(worker.schedule(
             [task, this] {
                 task();
                 terminator();
             },
-            delay);
+            delay));
     }
 
     template <class S> static std::chrono::milliseconds duration_since(S s) {
@@ -100,6 +103,235 @@ TEST_F(WorkerTest, EnqueueFromEnqueuedTask) {
     ASSERT_EQ(schedule(outer_task), false);
 }
 
+TEST_F(WorkerTest, EnqueueMoreTasksThanInboxCapacity) {
+    uint32_t task_count = 4096;
+    std::vector<uint32_t> x;
+
+    for (uint32_t i = 0; i < task_count; ++i) {
+        ASSERT_EQ(schedule([&x, i] { x.push_back(i); }), true);
+    }
+
+    worker.run();
+    ASSERT_EQ(x.size(), task_count);
+    for (uint32_t i = 0; i < task_count; ++i) {
+        ASSERT_EQ(x[i], i);
+    }
+}
+
+TEST_F(WorkerTest, ScheduleBulk) {
+    uint32_t task_count = 3000; // More than the inbox can hold.
+    std::vector<uint32_t> x;
+    std::vector<spindle::Task> tasks;
+    for (uint32_t i = 0; i < task_count; ++i) {
+        tasks.emplace_back([&x, i] { x.push_back(i); });
+    }
+    tasks.emplace_back([this] { worker.terminate(); });
+
+    ASSERT_EQ(worker.schedule_bulk(tasks.data(), tasks.size()), tasks.size());
+
+    worker.run();
+    ASSERT_EQ(x.size(), task_count);
+    for (uint32_t i = 0; i < task_count; ++i) {
+        ASSERT_EQ(x[i], i);
+    }
+
+    ASSERT_EQ(worker.schedule_bulk(tasks.data(), 1), 0);
+}
+
+TEST_F(WorkerTest, Load) {
+    // The `Worker` is not running, and thus not idle.
+    ASSERT_EQ(worker.load(), 1);
+
+    // Tasks that spill over the inbox count too.
+    uint32_t task_count = 3000;
+    for (uint32_t i = 0; i < task_count; ++i) {
+        ASSERT_TRUE(worker.schedule([] {}));
+    }
+    std::vector<spindle::Task> tasks;
+    for (int i = 0; i < 10; ++i) {
+        tasks.emplace_back([] {});
+    }
+    ASSERT_EQ(worker.schedule_bulk(tasks.data(), tasks.size()), tasks.size());
+    ASSERT_TRUE(worker.schedule_pinned([] {}));
+    // Runs last, as it spills over too.
+    ASSERT_TRUE(worker.schedule([this] { worker.terminate(); }));
+    ASSERT_EQ(worker.load(), task_count + tasks.size() + 3);
+
+    spindle::Task func;
+    ASSERT_TRUE(worker.steal(func));
+    ASSERT_EQ(worker.load(), task_count + tasks.size() + 2);
+
+    worker.run();
+    ASSERT_EQ(worker.load(), 1);
+}
+
+TEST_F(WorkerTest, StealImmediateTask) {
+    int x = 0;
+    spindle::Task func;
+
+    ASSERT_TRUE(worker.schedule([&] { x = 1; }));
+    ASSERT_TRUE(worker.schedule([&] { x = 2; }, std::chrono::milliseconds{100}));
+
+    // Only the immediate task can be stolen.
+    ASSERT_EQ(worker.steal(func), true);
+    ASSERT_EQ(worker.steal(func), false);
+
+    func();
+    ASSERT_EQ(x, 1);
+}
+
+TEST_F(WorkerTest, Priorities) {
+    std::vector<spindle::Priority> order;
+    for (spindle::Priority priority :
+         {spindle::Priority::background, spindle::Priority::normal, spindle::Priority::critical}) {
+        for (int i = 0; i < 32; ++i) {
+            worker.schedule([&order, priority] { order.push_back(priority); }, priority);
+        }
+    }
+    worker.schedule([&] { worker.terminate(); }, spindle::Priority::background);
+    worker.run();
+
+    // Each class gets its share of every 16 turns while all of them are backlogged.
+    ASSERT_EQ(order.size(), 96);
+    for (size_t i = 0; i < 16; ++i) {
+        spindle::Priority expected = spindle::Priority::critical;
+        if (i == 15) {
+            expected = spindle::Priority::background;
+        } else if (i % 4 == 3) {
+            expected = spindle::Priority::normal;
+        }
+        ASSERT_EQ(order[i], expected);
+    }
+
+    spindle::QueueingDelay delay = worker.queueing_delay(spindle::Priority::critical);
+    ASSERT_EQ(delay.tasks, 32);
+    ASSERT_GE(delay.total, delay.max);
+    ASSERT_EQ(worker.queueing_delay(spindle::Priority::background).tasks, 33);
+}
+
+TEST_F(WorkerTest, PinnedTask) {
+    int x = 0;
+    spindle::Task func;
+
+    ASSERT_EQ(worker.schedule_pinned([&] { x = 1; }), true);
+    ASSERT_TRUE(worker.schedule([&] { worker.terminate(); }));
+
+    // Only the regular task can be stolen, and the pinned one runs first.
+    ASSERT_EQ(worker.steal(func), true);
+    ASSERT_EQ(worker.steal(func), false);
+    ASSERT_TRUE(worker.schedule([&] { worker.terminate(); }));
+
+    worker.run();
+    ASSERT_EQ(x, 1);
+    ASSERT_EQ(worker.schedule_pinned([] {}), false);
+}
+
+TEST_F(WorkerTest, RunStolenTasks) {
+    spindle::Worker victim;
+    worker.add_peer(&victim);
+    int x = 0;
+
+    for (int i = 0; i < 3; ++i) {
+        victim.schedule([&] {
+            if (++x == 3) worker.terminate();
+        });
+    }
+
+    worker.run();
+    ASSERT_EQ(x, 3);
+
+    spindle::Task func;
+    ASSERT_EQ(victim.steal(func), false);
+}
+
+TEST_F(WorkerTest, CancelTasks) {
+    int x = 0;
+    spindle::TaskHandle deferred = worker.schedule([&] { x = 1; }, std::chrono::milliseconds{1});
+    spindle::TaskHandle immediate = worker.schedule_cancellable([&] { x = 2; });
+    spindle::TaskHandle last =
+        worker.schedule([&] { worker.terminate(); }, std::chrono::milliseconds{10});
+
+    ASSERT_EQ(deferred.cancel(), true);
+    ASSERT_EQ(deferred.cancel(), false);
+    ASSERT_EQ(deferred.cancelled(), true);
+    ASSERT_EQ(immediate.cancel(), true);
+    worker.run();
+
+    ASSERT_EQ(x, 0);
+    // The task already ran.
+    ASSERT_EQ(last.cancel(), false);
+    ASSERT_EQ(last.cancelled(), false);
+    ASSERT_EQ(spindle::TaskHandle{}.cancel(), false);
+}
+
+TEST_F(WorkerTest, CancelPeriodicTask) {
+    int x = 0;
+    spindle::TaskHandle handle;
+    handle = worker.schedule(
+        [&] {
+            if (++x == 3) {
+                ASSERT_EQ(handle.cancel(), true);
+            }
+        },
+        std::chrono::milliseconds{1},
+        true);
+    worker.schedule([&] { worker.terminate(); }, std::chrono::milliseconds{20});
+
+    worker.run();
+    ASSERT_EQ(x, 3);
+}
+
+TEST_F(WorkerTest, DiscardCancelledTasks) {
+    std::vector<spindle::TaskHandle> handles;
+    for (int i = 0; i < 1000; ++i) {
+        handles.push_back(worker.schedule([] {}, std::chrono::hours{1}));
+    }
+    for (spindle::TaskHandle& handle : handles) {
+        handle.cancel();
+    }
+    ASSERT_EQ(worker.metrics().deferred, 1000);
+
+    // Cancelled tasks are removed once they make up most of the deferred ones.
+    spindle::TaskHandle last = worker.schedule([] {}, std::chrono::hours{1});
+    ASSERT_EQ(worker.metrics().deferred, 1);
+
+    // A draining worker does not wait for cancelled tasks to come up.
+    last.cancel();
+    std::thread runner{[this] { worker.run(); }};
+    worker.drain();
+    runner.join();
+    ASSERT_EQ(worker.metrics().deferred, 0);
+}
+
+TEST_F(WorkerTest, Metrics) {
+    spindle::Worker victim;
+    worker.add_peer(&victim);
+
+    worker.schedule([] {}, spindle::Priority::critical);
+    worker.schedule([] {}, std::chrono::hours{1});
+    victim.schedule([&] { worker.terminate(); });
+
+    spindle::WorkerMetrics metrics = worker.metrics();
+    ASSERT_EQ(metrics.queued, 1);
+    ASSERT_EQ(metrics.deferred, 1);
+    ASSERT_EQ(metrics.executed, 0);
+    ASSERT_EQ(metrics.busy_time.count(), 0);
+
+    // The worker runs its own task, and then steals the other one.
+    worker.run();
+    metrics = worker.metrics();
+    ASSERT_EQ(metrics.queued, 0);
+    ASSERT_EQ(metrics.deferred, 1);
+    ASSERT_EQ(metrics.executed, 2);
+    ASSERT_EQ(metrics.stolen, 1);
+    ASSERT_GT(metrics.busy_time.count(), 0);
+    ASSERT_EQ(metrics.queueing_delay[0].count(), 1);
+    ASSERT_EQ(victim.metrics().queueing_delay[1].count(), 1);
+
+    // Time is not accounted for while the worker is stopped.
+    ASSERT_EQ(worker.metrics().busy_time, metrics.busy_time);
+}
+
 TEST_F(WorkerTest, DeferredTask) {
 #if SPINDLE_WORKER_DEFERRED_TASK_TESTS_SKIP
     GTEST_SKIP();
@@ -296,3 +528,29 @@ TEST_F(WorkerTest, PeriodicDeferredTask) {
     worker.run();
     ASSERT_EQ(x, num_iters);
 }
+
+TEST_F(WorkerTest, CoarseTimerResolution) {
+#if SPINDLE_WORKER_DEFERRED_TASK_TESTS_SKIP
+    GTEST_SKIP();
+#endif
+
+    std::chrono::milliseconds resolution{20};
+    std::chrono::milliseconds delay_ms{50};
+    std::chrono::milliseconds delay;
+    spindle::Worker coarse_worker{resolution};
+
+    spindle::clock::time_point start = spindle::clock::now();
+    coarse_worker.schedule(
+        [&] {
+            delay = duration_since(start);
+            coarse_worker.terminate();
+        },
+        delay_ms);
+
+    coarse_worker.run();
+
+    // Deferred tasks never run early and run at most one tick late.
+    long tol = delay_ms.count() * delay_tol_pct / 100;
+    ASSERT_GE(delay.count(), delay_ms.count());
+    ASSERT_LE(delay.count(), delay_ms.count() + resolution.count() + tol);
+}